@@ -0,0 +1,494 @@
+/* This implementation is based on the paper titled "Multiple Pursuer Multiple
+ * Evader Differential Games". Specifically, the 2 pursuer, 2 evader game
+ * described in Section III.
+ *
+ * @ARTICLE{9122473,
+ * author={Garcia, Eloy and Casbeer, David W. and Von Moll, Alexander and
+ * Pachter, Meir},
+ * journal={IEEE Transactions on Automatic Control},
+ * title={Multiple Pursuer Multiple Evader Differential Games},
+ * year={2021},
+ * volume={66},
+ * number={5},
+ * pages={2345-2350},
+ * keywords={Games;State feedback;Government;Aerospace
+ * electronics;Switches;Weapons;Autonomous systems;intelligent control;optimal
+ * control},
+ * doi={10.1109/TAC.2020.3003840}}
+ */
+
+#include <math.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+
+#include "dynsys.h"
+#include "dynsys_stepper.h"
+#include "game.h"
+#include "trig.h"
+#include "utils.h"
+
+/* Player velocities */
+
+#define P1_VEL (45.0)
+#define P2_VEL (40.0)
+#define E1_VEL (25.0)
+#define E2_VEL (20.0)
+
+static const real_t RATIOS[2][2] = {
+    {E1_VEL / P1_VEL, E2_VEL / P1_VEL},
+    {E1_VEL / P2_VEL, E2_VEL / P2_VEL},
+};
+
+/* Game dynamics */
+
+static void game_d(const void *x, real_t *dxdt);
+static size_t game_vars(void *x, real_t **vars);
+static void game_u(void *x, double t, double dt, void *ctx);
+static bool game_done(const void *x);
+static double game_event(const void *x);
+static double game_event_rate(const void *x);
+static bool game_init(void *x, double w, double h, rng_t *rng);
+
+/* Batched game dynamics */
+
+static void game_batch_f(void *x, size_t k, double dt);
+static void game_batch_u(void *x, size_t k, double dt);
+static size_t game_batch_done(void *x, size_t k, double t, double *t_end);
+static bool game_batch_init(void *x, const void *tmpl, size_t k, double w,
+                            double h, rng_t *rng);
+static void game_batch_free(void *x);
+
+enum player_e {
+  P1 = 0,
+  P2 = 1,
+  E1 = 2,
+  E2 = 3,
+  N_PLAYERS = 4,
+};
+
+static const real_t VELS[N_PLAYERS] = {P1_VEL, P2_VEL, E1_VEL, E2_VEL};
+
+/* The state of K games, as one array of K values per state variable. Players'
+ * headings are stored as unit vectors, since the dynamics only ever use their
+ * cosine and sine.
+ */
+struct game_batch {
+  real_t *x[N_PLAYERS];  /* Positions */
+  real_t *y[N_PLAYERS];  /* Positions */
+  real_t *ux[N_PLAYERS]; /* Headings */
+  real_t *uy[N_PLAYERS]; /* Headings */
+  real_t *live;          /* 1 while the game is running, 0 once it's over */
+  real_t *h;             /* Length of each game's last step */
+  real_t *rest;          /* Time left in the last step after a capture, or -1 */
+  real_t capture_radius; /* Capture radius of pursuers */
+};
+
+static const game_batch_desc_t game_batch_desc = {
+    .size = sizeof(struct game_batch),
+    .init = game_batch_init,
+    .free = game_batch_free,
+    .f = game_batch_f,
+    .u = game_batch_u,
+    .g = NULL,
+    .q = NULL,
+    .done = game_batch_done,
+};
+
+DYNSYS_DEFINE_STEPPER(game_step, game_d, game_u, NULL, game_event)
+
+static const game_param_t game_params[] = {
+    GAME_PARAM(struct game, capture_radius, PARAM_REAL, 0.0),
+};
+
+const game_desc_t game_desc = {
+    .name = "2p2e",
+    .size = sizeof(struct game),
+    .dt = TIMESTEP,
+    .params = game_params,
+    .n_params = sizeof(game_params) / sizeof(game_params[0]),
+    .init = game_init,
+    .free = NULL,
+    .f = NULL,
+    .d = game_d,
+    .vars = game_vars,
+    .agent_vars = sizeof(struct player) / sizeof(real_t),
+    .method = INTEGRATOR_EULER,
+    .step = game_step,
+    .u = game_u,
+    .g = NULL,
+    .q = NULL,
+    .done = game_done,
+    .event = game_event,
+    .event_rate = game_event_rate,
+    .batch = &game_batch_desc,
+};
+
+/* Random initial positions for all players */
+static bool game_init(void *x, double w, double h, rng_t *rng) {
+  struct game *game = (struct game *)x;
+  struct player *players[] = {&game->p1, &game->p2, &game->e1, &game->e2};
+
+  for (unsigned i = 0; i < 4; i++) {
+    players[i]->pos.x = rng_uniform(rng, 0.0, w);
+    players[i]->pos.y = rng_uniform(rng, 0.0, h);
+    players[i]->heading = 0.0;
+  }
+
+  game_u(x, 0.0, 0.0, NULL); /* Start out on the optimal headings */
+  return true;
+}
+
+/* The game ends when any evader is captured */
+static bool game_done(const void *x) {
+  const struct game *game = (const struct game *)x;
+  const struct player *pursuers[] = {&game->p1, &game->p2};
+  const struct player *evaders[] = {&game->e1, &game->e2};
+
+  for (unsigned i = 0; i < 2; i++) {
+    for (unsigned j = 0; j < 2; j++) {
+      real_t dist = vec2d_dist_r((vec2d_t *)&evaders[j]->pos,
+                                 (vec2d_t *)&pursuers[i]->pos);
+      if (f_is_equal(dist, game->capture_radius, CAPTURE_TOLERANCE)) {
+        return true;
+      }
+    }
+  }
+
+  return false;
+}
+
+/* Capture happens as the distance between any pursuer and evader drops to the
+ * capture radius, within the capture tolerance.
+ */
+static double game_event(const void *x) {
+  const struct game *game = (const struct game *)x;
+  const struct player *pursuers[] = {&game->p1, &game->p2};
+  const struct player *evaders[] = {&game->e1, &game->e2};
+  real_t closest = INFINITY;
+
+  for (unsigned i = 0; i < 2; i++) {
+    for (unsigned j = 0; j < 2; j++) {
+      real_t dist = vec2d_dist_r((vec2d_t *)&evaders[j]->pos,
+                                 (vec2d_t *)&pursuers[i]->pos);
+      if (dist < closest) closest = dist;
+    }
+  }
+
+  return closest - (game->capture_radius + CAPTURE_TOLERANCE);
+}
+
+/* No pursuer and evader close in faster than the fastest of each together */
+static double game_event_rate(const void *x) {
+  unused(x);
+  return P1_VEL + E1_VEL;
+}
+
+/* All players are integrated. Headings only change with the controls, so the
+ * velocities are constant over a step and Euler integration is exact.
+ */
+static size_t game_vars(void *x, real_t **vars) {
+  *vars = (real_t *)x;
+  return offsetof(struct game, capture_radius) / sizeof(real_t);
+}
+
+/* Dynamics of a single "simple" agent (holonomic) */
+static void player_d(const struct player *p, real_t vel, real_t *dxdt) {
+  real_t s, c;
+  real_sincos(p->heading, &s, &c);
+  dxdt[0] = vel * c;
+  dxdt[1] = vel * s;
+  dxdt[2] = 0.0;
+}
+
+/* Dynamics for all players */
+static void game_d(const void *x, real_t *dxdt) {
+  const struct game *game = (const struct game *)x;
+  player_d(&game->p1, P1_VEL, &dxdt[0]);
+  player_d(&game->p2, P2_VEL, &dxdt[3]);
+  player_d(&game->e1, E1_VEL, &dxdt[6]);
+  player_d(&game->e2, E2_VEL, &dxdt[9]);
+}
+static real_t y_ij(unsigned i, unsigned j, real_t *xp, real_t *xe, real_t *yp,
+                   real_t *ye) {
+#define a(i, j) (RATIOS[i][j])
+  return (ye[j] - a(i, j) * a(i, j) * yp[i] -
+          a(i, j) * vec2d_dist_r(vec2d_temp(xp[i], yp[i]),
+                                 vec2d_temp(xe[j], ye[j]))) /
+         (1 - (a(i, j) * a(i, j)));
+}
+
+static void opt_aimpoints(struct game *game, real_t *xe1, real_t *ye1,
+                          real_t *xe2, real_t *ye2, real_t *xp1, real_t *yp1,
+                          real_t *xp2, real_t *yp2) {
+  real_t xp[] = {game->p1.pos.x, game->p2.pos.x};
+  real_t xe[] = {game->e1.pos.x, game->e2.pos.x};
+  real_t yp[] = {game->p1.pos.y, game->p2.pos.y};
+  real_t ye[] = {game->e1.pos.y, game->e2.pos.y};
+
+  real_t ys1 = y_ij(0, 0, xp, xe, yp, ye) + y_ij(1, 1, xp, xe, yp, ye);
+  real_t ys2 = y_ij(0, 1, xp, xe, yp, ye) + y_ij(1, 0, xp, xe, yp, ye);
+
+#define a_11 (RATIOS[0][0])
+#define a_12 (RATIOS[0][1])
+#define a_21 (RATIOS[1][0])
+#define a_22 (RATIOS[1][1])
+#define a_den(a) (1 - ((a) * (a)))
+#define d(i, j) vec2d_dist_r(vec2d_temp(xp[i], yp[i]), vec2d_temp(xe[j], ye[j]))
+
+  if (ys1 > ys2) {
+    /* Equation 10 */
+    *xe1 = (xe[0] - (a_11 * a_11) * xp[0]) / a_den(a_11);
+    *ye1 =
+        (ye[0] - (a_11 * a_11) * yp[0] - (a_11 * a_11) * d(0, 0)) / a_den(a_11);
+    *xe2 = (xe[1] - (a_22 * a_22) * xp[1]) / a_den(a_22);
+    *ye2 =
+        (ye[1] - (a_22 * a_22) * yp[1] - (a_22 * a_22) * d(1, 1)) / a_den(a_22);
+    *xp1 = *xe1;
+    *yp1 = *ye1;
+    *xp2 = *xe2;
+    *yp2 = *ye2;
+  } else {
+    /* Equation 11 */
+    *xe1 = (xe[0] - (a_21 * a_21) * xp[1]) / a_den(a_21);
+    *ye1 =
+        (ye[0] - (a_21 * a_21) * yp[1] - (a_21 * a_21) * d(1, 0)) / a_den(a_21);
+    *xe2 = (xe[1] - (a_12 * a_12) * xp[0]) / a_den(a_12);
+    *ye2 =
+        (ye[1] - (a_12 * a_12) * yp[0] - (a_12 * a_12) * d(0, 1)) / a_den(a_12);
+    *xp2 = *xe1;
+    *yp2 = *ye1;
+    *xp1 = *xe2;
+    *yp1 = *ye2;
+  }
+}
+
+static void game_u(void *x, double t, double dt, void *ctx) {
+  struct game *game = (struct game *)x;
+  unused(t);
+  unused(dt);
+  unused(ctx);
+
+  real_t ex1;
+  real_t px1;
+  real_t ex2;
+  real_t px2;
+  real_t ey1;
+  real_t py1;
+  real_t ey2;
+  real_t py2;
+
+  /* Calculate the optimal aim points for each agent */
+
+  opt_aimpoints(game, &ex1, &ey1, &ex2, &ey2, &px1, &py1, &px2, &py2);
+
+  /* From the optimal aim points, we can compute the optimal headings. Taken
+   * from Equation 9.
+   */
+
+  game->e1.heading = real_atan2(ey1 - game->e1.pos.y, ex1 - game->e1.pos.x);
+  game->e2.heading = real_atan2(ey2 - game->e2.pos.y, ex2 - game->e2.pos.x);
+  game->p1.heading = real_atan2(py1 - game->p1.pos.y, px1 - game->p1.pos.x);
+  game->p2.heading = real_atan2(py2 - game->p2.pos.y, px2 - game->p2.pos.x);
+}
+
+/* Batched variant of the game, which computes the same dynamics and controls
+ * as the functions above for K games at once.
+ */
+
+#define BATCH_ALIGN (64)
+#define BATCH_LANES (BATCH_ALIGN / sizeof(real_t)) /* Scalars per cache line */
+
+static bool game_batch_init(void *x, const void *tmpl, size_t k, double w,
+                            double h, rng_t *rng) {
+  struct game_batch *b = (struct game_batch *)x;
+  const struct game *game = (const struct game *)tmpl;
+
+  /* One allocation for all arrays, each starting on its own cache line */
+
+  size_t kp = (k + BATCH_LANES - 1) & ~(BATCH_LANES - 1);
+  real_t *mem =
+      aligned_alloc(BATCH_ALIGN, sizeof(real_t) * kp * (4 * N_PLAYERS + 3));
+  if (mem == NULL) return false;
+
+  for (unsigned p = 0; p < N_PLAYERS; p++) {
+    b->x[p] = mem + (4 * p + 0) * kp;
+    b->y[p] = mem + (4 * p + 1) * kp;
+    b->ux[p] = mem + (4 * p + 2) * kp;
+    b->uy[p] = mem + (4 * p + 3) * kp;
+  }
+  b->live = mem + 4 * N_PLAYERS * kp;
+  b->h = b->live + kp;
+  b->rest = b->h + kp;
+  b->capture_radius = game->capture_radius;
+
+  /* Same random draws as game_init, one game after the other */
+
+  for (size_t n = 0; n < k; n++) {
+    for (unsigned p = 0; p < N_PLAYERS; p++) {
+      b->x[p][n] = rng_uniform(rng, 0.0, w);
+      b->y[p][n] = rng_uniform(rng, 0.0, h);
+      b->ux[p][n] = 1.0;
+      b->uy[p][n] = 0.0;
+    }
+    b->live[n] = 1.0;
+    b->rest[n] = -1.0;
+  }
+
+  game_batch_u(x, k, 0.0); /* Start out on the optimal headings */
+  return true;
+}
+
+static void game_batch_free(void *x) {
+  struct game_batch *b = (struct game_batch *)x;
+  free(b->x[0]); /* Start of the single allocation */
+}
+
+/* Games end at their capture, which the dynamics locate within the step */
+static size_t game_batch_done(void *x, size_t k, double t, double *t_end) {
+  struct game_batch *b = (struct game_batch *)x;
+  size_t running = 0;
+
+  for (size_t n = 0; n < k; n++) {
+    if (b->live[n] != 0.0) running++;
+    if (b->rest[n] >= 0.0) t_end[n] = t - b->rest[n];
+  }
+
+  return running;
+}
+
+/* First time within a step at which a pursuer and an evader moving in straight
+ * lines come within distance r of each other, from their relative position
+ * (rx, ry) and velocity (vx, vy). Infinite if they never do.
+ */
+static inline real_t batch_capture(real_t rx, real_t ry, real_t vx, real_t vy,
+                                   real_t r) {
+  real_t pb = rx * vx + ry * vy;
+  real_t pc = rx * rx + ry * ry - r * r;
+  real_t disc = pb * pb - (vx * vx + vy * vy) * pc;
+  real_t root = real_sqrt(disc > 0.0 ? disc : 0.0);
+
+  /* The smaller root of |(rx, ry) + t * (vx, vy)| = r, written so as not to
+   * cancel
+   */
+
+  real_t hit = (pb < 0.0) & (disc >= 0.0) ? pc / (root - pb) : (real_t)INFINITY;
+  return pc > 0.0 ? hit : 0.0;
+}
+
+/* Dynamics for all players of all games. Players move in straight lines over a
+ * step, so the capture is found exactly, as the scalar game's event, and the
+ * game stops there. Games which are over are frozen.
+ */
+static void game_batch_f(void *x, size_t k, double dt) {
+  struct game_batch *b = (struct game_batch *)x;
+  real_t *restrict live = b->live;
+  real_t *restrict h = b->h;
+  real_t *restrict rest = b->rest;
+  real_t r = b->capture_radius + CAPTURE_TOLERANCE;
+  real_t step = dt;
+
+#define b_capture(i, j)                                                        \
+  batch_capture(b->x[j][n] - b->x[i][n], b->y[j][n] - b->y[i][n],              \
+                VELS[j] * b->ux[j][n] - VELS[i] * b->ux[i][n],                 \
+                VELS[j] * b->uy[j][n] - VELS[i] * b->uy[i][n], r)
+
+#pragma GCC ivdep
+  for (size_t n = 0; n < k; n++) {
+    real_t hit1 = b_capture(P1, E1);
+    real_t hit2 = b_capture(P1, E2);
+    real_t hit3 = b_capture(P2, E1);
+    real_t hit4 = b_capture(P2, E2);
+    real_t first12 = hit1 < hit2 ? hit1 : hit2;
+    real_t first34 = hit3 < hit4 ? hit3 : hit4;
+    real_t first = first12 < first34 ? first12 : first34;
+
+    bool caught = (live[n] != 0.0) & (first <= step);
+    h[n] = caught ? first : live[n] * step;
+    rest[n] = caught ? step - first : -1.0;
+    live[n] = caught ? 0.0 : live[n];
+  }
+
+  for (unsigned p = 0; p < N_PLAYERS; p++) {
+    real_t *restrict px = b->x[p];
+    real_t *restrict py = b->y[p];
+    const real_t *restrict ux = b->ux[p];
+    const real_t *restrict uy = b->uy[p];
+    real_t vel = VELS[p];
+
+#pragma GCC ivdep
+    for (size_t n = 0; n < k; n++) {
+      px[n] += vel * h[n] * ux[n];
+      py[n] += vel * h[n] * uy[n];
+    }
+  }
+}
+
+/* Unit vector from (px, py) towards the aim point (ax, ay). Like atan2, an aim
+ * point on top of the player gives a heading of 0.
+ */
+static inline void batch_heading(real_t ax, real_t ay, real_t px, real_t py,
+                                 real_t *ux, real_t *uy) {
+  real_t dx = ax - px;
+  real_t dy = ay - py;
+  real_t d = real_sqrt(dx * dx + dy * dy);
+  *ux = d > 0.0 ? dx / d : 1.0;
+  *uy = d > 0.0 ? dy / d : 0.0;
+}
+
+static void game_batch_u(void *x, size_t k, double dt) {
+  struct game_batch *b = (struct game_batch *)x;
+  unused(dt);
+
+#define a2(i, j) (RATIOS[i][j] * RATIOS[i][j])
+#define b_den(i, j) (1 - a2(i, j))
+#define b_dist(x0, y0, x1, y1)                                                 \
+  real_sqrt(((x0) - (x1)) * ((x0) - (x1)) + ((y0) - (y1)) * ((y0) - (y1)))
+#define b_y_ij(i, j, ypi, yej, dij)                                            \
+  (((yej) - a2(i, j) * (ypi) - RATIOS[i][j] * (dij)) / b_den(i, j))
+
+  const real_t *restrict xp0 = b->x[P1];
+  const real_t *restrict yp0 = b->y[P1];
+  const real_t *restrict xp1 = b->x[P2];
+  const real_t *restrict yp1 = b->y[P2];
+  const real_t *restrict xe0 = b->x[E1];
+  const real_t *restrict ye0 = b->y[E1];
+  const real_t *restrict xe1 = b->x[E2];
+  const real_t *restrict ye1 = b->y[E2];
+
+#pragma GCC ivdep
+  for (size_t n = 0; n < k; n++) {
+    real_t d00 = b_dist(xp0[n], yp0[n], xe0[n], ye0[n]);
+    real_t d01 = b_dist(xp0[n], yp0[n], xe1[n], ye1[n]);
+    real_t d10 = b_dist(xp1[n], yp1[n], xe0[n], ye0[n]);
+    real_t d11 = b_dist(xp1[n], yp1[n], xe1[n], ye1[n]);
+
+    real_t ys1 = b_y_ij(0, 0, yp0[n], ye0[n], d00) +
+                 b_y_ij(1, 1, yp1[n], ye1[n], d11);
+    real_t ys2 = b_y_ij(0, 1, yp0[n], ye1[n], d01) +
+                 b_y_ij(1, 0, yp1[n], ye0[n], d10);
+    bool eq10 = ys1 > ys2;
+
+    /* Aim points of the evaders from Equation 10 or Equation 11 */
+
+    real_t xa1 = eq10 ? (xe0[n] - a2(0, 0) * xp0[n]) / b_den(0, 0)
+                      : (xe0[n] - a2(1, 0) * xp1[n]) / b_den(1, 0);
+    real_t ya1 =
+        eq10 ? (ye0[n] - a2(0, 0) * yp0[n] - a2(0, 0) * d00) / b_den(0, 0)
+             : (ye0[n] - a2(1, 0) * yp1[n] - a2(1, 0) * d10) / b_den(1, 0);
+    real_t xa2 = eq10 ? (xe1[n] - a2(1, 1) * xp1[n]) / b_den(1, 1)
+                      : (xe1[n] - a2(0, 1) * xp0[n]) / b_den(0, 1);
+    real_t ya2 =
+        eq10 ? (ye1[n] - a2(1, 1) * yp1[n] - a2(1, 1) * d11) / b_den(1, 1)
+             : (ye1[n] - a2(0, 1) * yp0[n] - a2(0, 1) * d01) / b_den(0, 1);
+
+    /* Each pursuer aims at the aim point of its assigned evader */
+
+    batch_heading(xa1, ya1, xe0[n], ye0[n], &b->ux[E1][n], &b->uy[E1][n]);
+    batch_heading(xa2, ya2, xe1[n], ye1[n], &b->ux[E2][n], &b->uy[E2][n]);
+    batch_heading(eq10 ? xa1 : xa2, eq10 ? ya1 : ya2, xp0[n], yp0[n],
+                  &b->ux[P1][n], &b->uy[P1][n]);
+    batch_heading(eq10 ? xa2 : xa1, eq10 ? ya2 : ya1, xp1[n], yp1[n],
+                  &b->ux[P2][n], &b->uy[P2][n]);
+  }
+}
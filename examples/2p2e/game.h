@@ -0,0 +1,32 @@
+#ifndef DIFFGAMES_2P2E_GAME_H
+#define DIFFGAMES_2P2E_GAME_H
+
+#include "3dtools.h"
+#include "headless.h"
+
+#define TIMESTEP (0.01) /* Fraction of a second */
+
+/* System state */
+
+struct player {
+  vec2d_t pos;
+  real_t heading;
+};
+
+struct game {
+  struct player p1;
+  struct player p2;
+  struct player e1;
+  struct player e2;
+  real_t capture_radius; /* Capture radius of pursuers */
+};
+
+/* Game "constant" parameters */
+
+#define CAPTURE_TOLERANCE (0.08)
+
+/* Game description for headless simulation */
+
+extern const game_desc_t game_desc;
+
+#endif // DIFFGAMES_2P2E_GAME_H
@@ -1,21 +1,24 @@
 #define HELP_TEXT \
 "2 Pursuers, 2 Evaders\n\nDESCRIPTION:\n    This game is based on the paper " \
-"Multiple Pursuers Multiple Evader\n    Differential Games\" by Eloy Garcia, " \
-"David W. Casbeer, Alexander Von Moll and\n    Meir Pachter.\n\n    The game " \
-"consists of two pursuers and two evaders. The goal of the pursuers\n    is t" \
-"o capture the evaders (come within some capture radius distance of the\n    " \
-"evaders) in the shortest time possible. The evaders aim to avoid capture for" \
-"\n    as long as possible.\n\n    The two pursuers are always faster than bo" \
-"th of the evaders. All agents have\n    holonomic motion in an infinite 2D p" \
-"lane. The players are controlled by\n    their optimal control signals from " \
-"Section III of the paper. At run-time,\n    the players are all assigned ran" \
-"dom initial conditions (start locations and\n    headings).\n\n    The game " \
-"ends when an evader is captured.\n\nUSAGE:\n    2p2e [OPTIONS]\n\nOPTIONS:\n" \
-"    -h          Display this help text.\n    -x <width>  Window width in pix" \
-"els. Default is half screen width.\n    -y <height> Window height in pixels." \
-" Default is half screen height.\n    -s <scale>  Rendering scale. Default 5." \
-"\n    -r <radius> Capture radius of the pursuers in meters. Default 0.\n\nCO" \
-"NTROLS:\n    This game is visualized using SDL2 and accepts keyboard input." \
-"\n    q           Quit the game.\n    Esc         Quit the game.\n    r     " \
-"      Toggle visualization of the pursuer capture radius.\n    Space       R" \
-"e-seed and re-start the game.\n"
+"\"Multiple Pursuers Multiple Evader\n    Differential Games\" by Eloy Garcia" \
+", David W. Casbeer, Alexander Von Moll and\n    Meir Pachter.\n\n    The gam" \
+"e consists of two pursuers and two evaders. The goal of the pursuers\n    is" \
+" to capture the evaders (come within some capture radius distance of the\n  " \
+"  evaders) in the shortest time possible. The evaders aim to avoid capture f" \
+"or\n    as long as possible.\n\n    The two pursuers are always faster than " \
+"both of the evaders. All agents have\n    holonomic motion in an infinite 2D" \
+" plane. The players are controlled by\n    their optimal control signals fro" \
+"m Section III of the paper. At run-time,\n    the players are all assigned r" \
+"andom initial conditions (start locations and\n    headings).\n\n    The gam" \
+"e ends when an evader is captured.\n\nUSAGE:\n    2p2e [OPTIONS]\n\nOPTIONS:" \
+"\n    -h          Display this help text.\n    -x <width>  Window width in p" \
+"ixels. Default is half screen width.\n    -y <height> Window height in pixel" \
+"s. Default is half screen height.\n    -s <scale>  Rendering scale. Default " \
+"5.\n    -r <radius> Capture radius of the pursuers in meters. Default 0.\n  " \
+"  -f <factor> Simulation speed as a multiple of real-time, 0 to run as fast" \
+"\n                as possible. Default 1.\n    -S <seed>   Seed for the init" \
+"ial conditions. Default is current time.\n\nCONTROLS:\n    This game is visu" \
+"alized using SDL2 and accepts keyboard input.\n\n    q           Quit the ga" \
+"me.\n    Esc         Quit the game.\n    r           Toggle visualization of" \
+" the pursuer capture radius.\n    Space       Re-seed and re-start the game." \
+"\n"
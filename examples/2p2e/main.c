@@ -1,20 +1,5 @@
-/* This implementation is based on the paper titled "Multiple Pursuer Multiple
- * Evader Differential Games". Specifically, the 2 pursuer, 2 evader game
- * described in Section III.
- *
- * @ARTICLE{9122473,
- * author={Garcia, Eloy and Casbeer, David W. and Von Moll, Alexander and
- * Pachter, Meir},
- * journal={IEEE Transactions on Automatic Control},
- * title={Multiple Pursuer Multiple Evader Differential Games},
- * year={2021},
- * volume={66},
- * number={5},
- * pages={2345-2350},
- * keywords={Games;State feedback;Government;Aerospace
- * electronics;Switches;Weapons;Autonomous systems;intelligent control;optimal
- * control},
- * doi={10.1109/TAC.2020.3003840}}
+/* SDL front-end for the 2 pursuer, 2 evader game. The game itself lives in
+ * game.c so that it can also be simulated headlessly.
  */
 
 #include <getopt.h>
@@ -27,52 +12,16 @@
 #include <SDL2/SDL.h>
 
 #include "dynsys.h"
+#include "game.h"
 #include "helptext.h"
 #include "render.h"
+#include "simloop.h"
 #include "utils.h"
 
-#define TIMESTEP (0.01) /* Fraction of a second */
-
 const char WINDOW_NAME[] = "2 Pursuers, 2 Evaders";
 
-/* System state */
-
-struct player {
-  vec2d_t pos;
-  double heading;
-};
-
-struct game {
-  struct player p1;
-  struct player p2;
-  struct player e1;
-  struct player e2;
-};
-
-/* Game "constant" parameters */
-
-#define CAPTURE_TOLERANCE (0.08)
-static double capture_radius = 0.0;
-
-/* Player velocities */
-
-#define P1_VEL (45.0)
-#define P2_VEL (40.0)
-#define E1_VEL (25.0)
-#define E2_VEL (20.0)
-
-static const double RATIOS[2][2] = {
-    {E1_VEL / P1_VEL, E2_VEL / P1_VEL},
-    {E1_VEL / P2_VEL, E2_VEL / P2_VEL},
-};
-
 #define CIRCLE_POINTS (15)
 
-/* Game dynamics */
-
-static void game_f(void *x, double dt);
-static void game_u(void *x, double dt);
-
 int main(int argc, char **argv) {
 
   double scale = 5.0;
@@ -83,9 +32,14 @@ int main(int argc, char **argv) {
   bool running = true;
   bool show_capture_radius = false;
   bool game_over = false;
+  unsigned seed = time(NULL);
+  rng_t rng;
+  double rate = 1.0;
+
+  game_params_default(&game_desc, &game_x);
 
   int c;
-  while ((c = getopt(argc, argv, ":hx:y:s:r:")) != -1) {
+  while ((c = getopt(argc, argv, ":hx:y:s:r:f:S:")) != -1) {
     switch (c) {
     case 'h':
       puts(HELP_TEXT);
@@ -98,11 +52,21 @@ int main(int argc, char **argv) {
       dm.h = strtoul(optarg, NULL, 10);
       break;
     case 'r':
-      capture_radius = strtod(optarg, NULL);
+      game_x.capture_radius = strtod(optarg, NULL);
       break;
     case 's':
       scale = strtod(optarg, NULL);
       break;
+    case 'S':
+      seed = strtoul(optarg, NULL, 10);
+      break;
+    case 'f':
+      rate = strtod(optarg, NULL);
+      if (rate < 0) {
+        fprintf(stderr, "Real-time factor must be >= 0.\n");
+        exit(EXIT_FAILURE);
+      }
+      break;
     case '?':
       fprintf(stderr, "Unknown option -%c\n", optopt);
       exit(EXIT_FAILURE);
@@ -141,14 +105,16 @@ int main(int argc, char **argv) {
 
   /* Set up game with random initial conditions */
 
-  srand(time(NULL));
-
-  for (unsigned i = 0; i < 4; i++) {
-    ((struct player *)(&game_x))[i].pos.x = randval(0.0, dm.w / scale);
-    ((struct player *)(&game_x))[i].pos.y = randval(0.0, dm.h / scale);
+  dynsys_t game;
+  rng_seed(&rng, seed);
+  game_desc.init(&game_x, dm.w / scale, dm.h / scale, &rng);
+  if (!game_dynsys_init(&game_desc, &game, &game_x)) {
+    fprintf(stderr, "Couldn't initialize the game.\n");
+    exit(EXIT_FAILURE);
   }
 
-  dynsys_t game = DYNSYS_SINIT(&game_x, game_f, game_u, NULL, NULL);
+  simloop_t loop;
+  simloop_init(&loop, TIMESTEP, rate);
 
   /* Simulation loop */
 
@@ -175,11 +141,13 @@ int main(int argc, char **argv) {
           show_capture_radius = !show_capture_radius;
           break;
         case SDLK_SPACE:
-          for (unsigned i = 0; i < 4; i++) {
-            ((struct player *)(&game_x))[i].pos.x = randval(0.0, dm.w / scale);
-            ((struct player *)(&game_x))[i].pos.y = randval(0.0, dm.h / scale);
+          game_desc.init(&game_x, dm.w / scale, dm.h / scale, &rng);
+          dynsys_free(&game);
+          if (!game_dynsys_init(&game_desc, &game, &game_x)) {
+            fprintf(stderr, "Couldn't initialize the game.\n");
+            exit(EXIT_FAILURE);
           }
-          dynsys_init(&game, &game_x, game_f, game_u, NULL, NULL);
+          simloop_reset(&loop);
           SDL_SetRenderDrawColor(renderer, 0, 0, 0, SDL_ALPHA_OPAQUE);
           SDL_RenderClear(renderer);
           SDL_RenderPresent(renderer);
@@ -216,10 +184,12 @@ int main(int argc, char **argv) {
     /* Draw pursuer capture radius in white */
 
     if ((show_capture_radius || game_over) &&
-        !f_is_zero(capture_radius, 0.01)) {
+        !f_is_zero(game_x.capture_radius, 0.01)) {
       SDL_SetRenderDrawColor(renderer, 255, 255, 255, SDL_ALPHA_OPAQUE);
-      render_circle(renderer, &game_x.p1.pos, capture_radius, CIRCLE_POINTS);
-      render_circle(renderer, &game_x.p2.pos, capture_radius, CIRCLE_POINTS);
+      render_circle(renderer, &game_x.p1.pos, game_x.capture_radius,
+                    CIRCLE_POINTS);
+      render_circle(renderer, &game_x.p2.pos, game_x.capture_radius,
+                    CIRCLE_POINTS);
     }
 
     /* Show what was drawn */
@@ -229,129 +199,26 @@ int main(int argc, char **argv) {
     /* Clear pursuer capture radius before next slide */
 
     if ((show_capture_radius || game_over) &&
-        !f_is_zero(capture_radius, 0.01)) {
+        !f_is_zero(game_x.capture_radius, 0.01)) {
       SDL_SetRenderDrawColor(renderer, 0, 0, 0, SDL_ALPHA_OPAQUE);
-      render_circle(renderer, &game_x.p1.pos, capture_radius, CIRCLE_POINTS);
-      render_circle(renderer, &game_x.p2.pos, capture_radius, CIRCLE_POINTS);
+      render_circle(renderer, &game_x.p1.pos, game_x.capture_radius,
+                    CIRCLE_POINTS);
+      render_circle(renderer, &game_x.p2.pos, game_x.capture_radius,
+                    CIRCLE_POINTS);
     }
 
     /* Advance simulation until a capture occurs */
 
-    game_over = f_is_equal(vec2d_dist_r(&game_x.e1.pos, &game_x.p1.pos),
-                           capture_radius, CAPTURE_TOLERANCE) ||
-                f_is_equal(vec2d_dist_r(&game_x.e1.pos, &game_x.p2.pos),
-                           capture_radius, CAPTURE_TOLERANCE) ||
-                f_is_equal(vec2d_dist_r(&game_x.e2.pos, &game_x.p1.pos),
-                           capture_radius, CAPTURE_TOLERANCE) ||
-                f_is_equal(vec2d_dist_r(&game_x.e2.pos, &game_x.p2.pos),
-                           capture_radius, CAPTURE_TOLERANCE);
-
-    if (!game_over) {
-      dynsys_step(&game, TIMESTEP);
-    }
+    simloop_advance(&loop, &game, game_desc.done);
+    game_over = loop.over;
   }
 
   /* Release resources */
 
+  dynsys_free(&game);
   SDL_DestroyRenderer(renderer);
   SDL_DestroyWindow(window);
   SDL_Quit();
 
   return EXIT_SUCCESS;
 }
-
-/* Dynamics of a single "simple" agent (holonomic) */
-static void player_f(struct player *p, double vel, double dt) {
-  p->pos.x += dt * vel * cos(p->heading);
-  p->pos.y += dt * vel * sin(p->heading);
-}
-
-/* Dynamics for all players */
-static void game_f(void *x, double dt) {
-  struct game *game = (struct game *)x;
-  player_f(&game->p1, P1_VEL, dt);
-  player_f(&game->p2, P2_VEL, dt);
-  player_f(&game->e1, E1_VEL, dt);
-  player_f(&game->e2, E2_VEL, dt);
-}
-
-static double y_ij(unsigned i, unsigned j, double *xp, double *xe, double *yp,
-                   double *ye) {
-#define a(i, j) (RATIOS[i][j])
-  return (ye[j] - a(i, j) * a(i, j) * yp[i] -
-          a(i, j) * vec2d_dist_r(vec2d_temp(xp[i], yp[i]),
-                                 vec2d_temp(xe[j], ye[j]))) /
-         (1.0 - (a(i, j) * a(i, j)));
-}
-
-static void opt_aimpoints(struct game *game, double *xe1, double *ye1,
-                          double *xe2, double *ye2, double *xp1, double *yp1,
-                          double *xp2, double *yp2) {
-  double xp[] = {game->p1.pos.x, game->p2.pos.x};
-  double xe[] = {game->e1.pos.x, game->e2.pos.x};
-  double yp[] = {game->p1.pos.y, game->p2.pos.y};
-  double ye[] = {game->e1.pos.y, game->e2.pos.y};
-
-  double ys1 = y_ij(0, 0, xp, xe, yp, ye) + y_ij(1, 1, xp, xe, yp, ye);
-  double ys2 = y_ij(0, 1, xp, xe, yp, ye) + y_ij(1, 0, xp, xe, yp, ye);
-
-#define a_11 (RATIOS[0][0])
-#define a_12 (RATIOS[0][1])
-#define a_21 (RATIOS[1][0])
-#define a_22 (RATIOS[1][1])
-#define a_den(a) (1.0 - ((a) * (a)))
-#define d(i, j) vec2d_dist_r(vec2d_temp(xp[i], yp[i]), vec2d_temp(xe[j], ye[j]))
-
-  if (ys1 > ys2) {
-    /* Equation 10 */
-    *xe1 = (xe[0] - (a_11 * a_11) * xp[0]) / a_den(a_11);
-    *ye1 =
-        (ye[0] - (a_11 * a_11) * yp[0] - (a_11 * a_11) * d(0, 0)) / a_den(a_11);
-    *xe2 = (xe[1] - (a_22 * a_22) * xp[1]) / a_den(a_22);
-    *ye2 =
-        (ye[1] - (a_22 * a_22) * yp[1] - (a_22 * a_22) * d(1, 1)) / a_den(a_22);
-    *xp1 = *xe1;
-    *yp1 = *ye1;
-    *xp2 = *xe2;
-    *yp2 = *ye2;
-  } else {
-    /* Equation 11 */
-    *xe1 = (xe[0] - (a_21 * a_21) * xp[1]) / a_den(a_21);
-    *ye1 =
-        (ye[0] - (a_21 * a_21) * yp[1] - (a_21 * a_21) * d(1, 0)) / a_den(a_21);
-    *xe2 = (xe[1] - (a_12 * a_12) * xp[0]) / a_den(a_12);
-    *ye2 =
-        (ye[1] - (a_12 * a_12) * yp[0] - (a_12 * a_12) * d(0, 1)) / a_den(a_12);
-    *xp2 = *xe1;
-    *yp2 = *ye1;
-    *xp1 = *xe2;
-    *yp1 = *ye2;
-  }
-}
-
-static void game_u(void *x, double dt) {
-  struct game *game = (struct game *)x;
-  unused(dt);
-
-  double ex1;
-  double px1;
-  double ex2;
-  double px2;
-  double ey1;
-  double py1;
-  double ey2;
-  double py2;
-
-  /* Calculate the optimal aim points for each agent */
-
-  opt_aimpoints(game, &ex1, &ey1, &ex2, &ey2, &px1, &py1, &px2, &py2);
-
-  /* From the optimal aim points, we can compute the optimal headings. Taken
-   * from Equation 9.
-   */
-
-  game->e1.heading = atan2(ey1 - game->e1.pos.y, ex1 - game->e1.pos.x);
-  game->e2.heading = atan2(ey2 - game->e2.pos.y, ex2 - game->e2.pos.x);
-  game->p1.heading = atan2(py1 - game->p1.pos.y, px1 - game->p1.pos.x);
-  game->p2.heading = atan2(py2 - game->p2.pos.y, px2 - game->p2.pos.x);
-}
@@ -0,0 +1,143 @@
+#include <math.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+
+#include "dynsys.h"
+#include "dynsys_stepper.h"
+#include "game.h"
+#include "trig.h"
+#include "utils.h"
+
+/* Game dynamics */
+
+static void game_d(const void *x, real_t *dxdt);
+static size_t game_vars(void *x, real_t **vars);
+static void game_u(void *x, double t, double dt, void *ctx);
+static double game_g(const void *x, double t, double dt, void *ctx);
+static bool game_done(const void *x);
+static double game_event(const void *x);
+static double game_event_rate(const void *x);
+static bool game_init(void *x, double w, double h, rng_t *rng);
+
+DYNSYS_DEFINE_STEPPER(game_step, game_d, game_u, game_g, game_event)
+
+static const game_param_t game_params[] = {
+    GAME_PARAM(struct game, chauffeur_vel, PARAM_REAL, 50.0),
+    GAME_PARAM(struct game, pedestrian_vel, PARAM_REAL, 25.0),
+    GAME_PARAM(struct game, capture_radius, PARAM_REAL, 0.0),
+    GAME_PARAM(struct game, turn_radius, PARAM_REAL, 5.0),
+};
+
+const game_desc_t game_desc = {
+    .name = "homicidal_chauffeur",
+    .size = sizeof(struct game),
+    .dt = TIMESTEP,
+    .params = game_params,
+    .n_params = sizeof(game_params) / sizeof(game_params[0]),
+    .init = game_init,
+    .free = NULL,
+    .f = NULL,
+    .d = game_d,
+    .vars = game_vars,
+    .agent_vars = sizeof(struct player) / sizeof(real_t),
+    .method = INTEGRATOR_RK4,
+    .step = game_step,
+    .u = game_u,
+    .g = game_g,
+    .q = NULL,
+    .done = game_done,
+    .event = game_event,
+    .event_rate = game_event_rate,
+    .batch = NULL,
+};
+
+/* Random initial conditions for both players */
+static bool game_init(void *x, double w, double h, rng_t *rng) {
+  struct game *game = (struct game *)x;
+
+  if (game->pedestrian_vel >= game->chauffeur_vel) return false;
+
+  game->chauf.pos.x = rng_uniform(rng, 0, w);
+  game->chauf.pos.y = rng_uniform(rng, 0, h);
+  game->chauf.heading = rng_uniform(rng, 0, 2 * M_PI);
+  game->ped.pos.x = rng_uniform(rng, 0, w);
+  game->ped.pos.y = rng_uniform(rng, 0, h);
+  game->ped.heading = 0.0;
+  game->phi = 0.0;
+  return true;
+}
+
+/* The game ends once the pedestrian is within the capture radius */
+static bool game_done(const void *x) {
+  const struct game *game = (const struct game *)x;
+  real_t curdist =
+      vec2d_dist_r((vec2d_t *)&game->chauf.pos, (vec2d_t *)&game->ped.pos);
+  return curdist <= game->capture_radius;
+}
+
+/* The players are integrated, the steering control is left alone */
+static size_t game_vars(void *x, real_t **vars) {
+  *vars = (real_t *)x;
+  return offsetof(struct game, phi) / sizeof(real_t);
+}
+
+/* Capture happens as the distance between the players drops to the capture
+ * radius.
+ */
+static double game_event(const void *x) {
+  const struct game *game = (const struct game *)x;
+  return vec2d_dist_r((vec2d_t *)&game->chauf.pos, (vec2d_t *)&game->ped.pos) -
+         game->capture_radius;
+}
+
+/* The players close in at most as fast as they both move */
+static double game_event_rate(const void *x) {
+  const struct game *game = (const struct game *)x;
+  return game->chauffeur_vel + game->pedestrian_vel;
+}
+
+/* Derivative of a player's position and heading */
+static void player_d(const struct player *p, real_t vel, real_t turn,
+                     real_t *dxdt) {
+  real_t s, c;
+  real_sincos(p->heading, &s, &c);
+  dxdt[0] = vel * s;
+  dxdt[1] = vel * c;
+  dxdt[2] = turn;
+}
+
+static void game_d(const void *x, real_t *dxdt) {
+  const struct game *game = (const struct game *)x;
+  real_t turn = (game->chauffeur_vel / game->turn_radius) * game->phi;
+  player_d(&game->chauf, game->chauffeur_vel, turn, &dxdt[0]);
+  player_d(&game->ped, game->pedestrian_vel, 0.0, &dxdt[3]);
+}
+
+static void game_u(void *x, double t, double dt, void *ctx) {
+  struct game *game = (struct game *)x;
+  unused(dt);
+  unused(ctx);
+  double rho = 0;
+  double sw = cos(rho + t) - cos(rho);
+
+  /* TODO: optimal chauffeur strategy */
+  if (f_is_zero(sw, 0.05)) {
+    game->phi = 0;
+  } else if (sw < 0.0) {
+    game->phi = -1;
+  } else {
+    game->phi = 1;
+  }
+
+  /* TODO: optimal evader strategy */
+  game->ped.heading = rho + t;
+}
+
+/* Running cost of the game is time to capture */
+static double game_g(const void *x, double t, double dt, void *ctx) {
+  unused(x);
+  unused(t);
+  unused(ctx);
+  return dt;
+}
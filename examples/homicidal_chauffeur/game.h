@@ -0,0 +1,36 @@
+#ifndef DIFFGAMES_HOMICIDAL_CHAUFFEUR_GAME_H
+#define DIFFGAMES_HOMICIDAL_CHAUFFEUR_GAME_H
+
+#include "3dtools.h"
+#include "headless.h"
+
+#define TIMESTEP (0.01)
+
+struct player {
+  vec2d_t pos;
+  real_t heading;
+};
+
+/* The state variables integrated by the dynamic system are the players, which
+ * come first. Everything from `phi` onwards is left untouched by the
+ * integrator.
+ */
+
+struct game {
+  struct player chauf;
+  struct player ped;
+  real_t phi; /* Chauffeur steering control, between -1 and 1 */
+
+  /* Game constants */
+
+  real_t chauffeur_vel;
+  real_t pedestrian_vel;
+  real_t capture_radius;
+  real_t turn_radius;
+};
+
+/* Game description for headless simulation */
+
+extern const game_desc_t game_desc;
+
+#endif // DIFFGAMES_HOMICIDAL_CHAUFFEUR_GAME_H
@@ -7,6 +7,9 @@
 "ocity in m/s. Default 50.0.\n    -e <vel>    The pedestrian's (positive) vel" \
 "ocity in m/s. Default 25.0.\n    -r <radius> The chauffeur's capture radius " \
 "in m. Default 0.\n    -t <radius> The chauffeur's turning radius in m. Defau" \
-"lt 5.0.\n\nCONTROLS:\n    This game is visualized using SDL2 and accepts key" \
-"board input.\n\n    q           Quit the game.\n    Esc         Quit the gam" \
-"e.\n    Space       Re-seed and restart the game.\n"
+"lt 5.0.\n    -f <factor> Simulation speed as a multiple of real-time, 0 to r" \
+"un as fast\n                as possible. Default 1.\n    -S <seed>   Seed fo" \
+"r the initial conditions. Default is current time.\n\nCONTROLS:\n    This ga" \
+"me is visualized using SDL2 and accepts keyboard input.\n\n    q           Q" \
+"uit the game.\n    Esc         Quit the game.\n    Space       Re-seed and r" \
+"estart the game.\n"
@@ -1,43 +1,23 @@
+/* SDL front-end for the homicidal chauffeur game, which lives in game.c */
+
 #include <getopt.h>
 #include <math.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <time.h>
 
 #include <SDL2/SDL.h>
 
 #include "dynsys.h"
+#include "game.h"
 #include "helptext.h"
 #include "render.h"
+#include "simloop.h"
 #include "utils.h"
 
 const char window_name[] = "Homicidal Chauffer";
 
-#define TIMESTEP (0.01)
-
-struct player {
-  vec2d_t pos;
-  double heading;
-};
-
-struct game {
-  struct player chauf;
-  struct player ped;
-};
-
-/* Game constants */
-
-static double chauffeur_vel = 50.0;
-static double pedestrian_vel = 25.0;
-static double capture_radius = 0.0;
-static double turn_radius = 5.0;
-
-/* Game dynamics */
-
-static void game_f(void *x, double dt);
-static void game_u(void *x, double dt);
-static double game_g(const void *x, double dt);
-
 int main(int argc, char **argv) {
   double scale = 5.0;
   SDL_DisplayMode dm = {0};
@@ -45,10 +25,14 @@ int main(int argc, char **argv) {
   SDL_Event event;
   struct game game_x;
   bool running = true;
-  bool game_over = false;
+  unsigned seed = time(NULL);
+  rng_t rng;
+  double rate = 1.0;
+
+  game_params_default(&game_desc, &game_x);
 
   int c;
-  while ((c = getopt(argc, argv, ":hx:y:s:v:r:t:e:")) != -1) {
+  while ((c = getopt(argc, argv, ":hx:y:s:v:r:t:e:f:S:")) != -1) {
     switch (c) {
     case 'h':
       puts(HELP_TEXT);
@@ -64,33 +48,43 @@ int main(int argc, char **argv) {
       scale = strtod(optarg, NULL);
       break;
     case 'v':
-      chauffeur_vel = strtod(optarg, NULL);
-      if (chauffeur_vel < 0) {
+      game_x.chauffeur_vel = strtod(optarg, NULL);
+      if (game_x.chauffeur_vel < 0) {
         fprintf(stderr, "Chauffeur velocity must be >= 0.\n");
         exit(EXIT_FAILURE);
       }
       break;
     case 'e':
-      pedestrian_vel = strtod(optarg, NULL);
-      if (pedestrian_vel < 0) {
+      game_x.pedestrian_vel = strtod(optarg, NULL);
+      if (game_x.pedestrian_vel < 0) {
         fprintf(stderr, "Pedestrian velocity must be >= 0.\n");
         exit(EXIT_FAILURE);
       }
       break;
     case 'r':
-      capture_radius = strtod(optarg, NULL);
-      if (capture_radius < 0) {
+      game_x.capture_radius = strtod(optarg, NULL);
+      if (game_x.capture_radius < 0) {
         fprintf(stderr, "Capture radius must be >= 0.\n");
         exit(EXIT_FAILURE);
       }
       break;
     case 't':
-      turn_radius = strtod(optarg, NULL);
-      if (turn_radius < 0) {
+      game_x.turn_radius = strtod(optarg, NULL);
+      if (game_x.turn_radius < 0) {
         fprintf(stderr, "Turning radius must be >= 0.\n");
         exit(EXIT_FAILURE);
       }
       break;
+    case 'S':
+      seed = strtoul(optarg, NULL, 10);
+      break;
+    case 'f':
+      rate = strtod(optarg, NULL);
+      if (rate < 0) {
+        fprintf(stderr, "Real-time factor must be >= 0.\n");
+        exit(EXIT_FAILURE);
+      }
+      break;
     case '?':
       fprintf(stderr, "Unknown option -%c\n", optopt);
       exit(EXIT_FAILURE);
@@ -98,7 +92,7 @@ int main(int argc, char **argv) {
     }
   }
 
-  if (pedestrian_vel >= chauffeur_vel) {
+  if (game_x.pedestrian_vel >= game_x.chauffeur_vel) {
     fprintf(stderr,
             "Pedestrian velocity must be less than the chauffeur velocity.\n");
     exit(EXIT_FAILURE);
@@ -135,12 +129,16 @@ int main(int argc, char **argv) {
 
   /* Set up game with initial conditons */
 
-  game_x.chauf.pos.x = randval(0, dm.w / scale);
-  game_x.chauf.pos.y = randval(0, dm.h / scale);
-  game_x.chauf.heading = randval(0, 2 * M_PI);
-  game_x.ped.pos.x = randval(0, dm.w / scale);
-  game_x.ped.pos.y = randval(0, dm.h / scale);
-  dynsys_t game = DYNSYS_SINIT(&game_x, game_f, game_u, game_g, NULL);
+  dynsys_t game;
+  rng_seed(&rng, seed);
+  game_desc.init(&game_x, dm.w / scale, dm.h / scale, &rng);
+  if (!game_dynsys_init(&game_desc, &game, &game_x)) {
+    fprintf(stderr, "Couldn't initialize the game.\n");
+    exit(EXIT_FAILURE);
+  }
+
+  simloop_t loop;
+  simloop_init(&loop, TIMESTEP, rate);
 
   /* Render simulation */
 
@@ -165,12 +163,13 @@ int main(int argc, char **argv) {
           running = false;
           break;
         case SDLK_SPACE:
-          game_x.chauf.pos.x = randval(0, dm.w / scale);
-          game_x.chauf.pos.y = randval(0, dm.h / scale);
-          game_x.chauf.heading = randval(0, 2 * M_PI);
-          game_x.ped.pos.x = randval(0, dm.w / scale);
-          game_x.ped.pos.y = randval(0, dm.h / scale);
-          dynsys_init(&game, &game_x, game_f, game_u, game_g, NULL);
+          game_desc.init(&game_x, dm.w / scale, dm.h / scale, &rng);
+          dynsys_free(&game);
+          if (!game_dynsys_init(&game_desc, &game, &game_x)) {
+            fprintf(stderr, "Couldn't initialize the game.\n");
+            exit(EXIT_FAILURE);
+          }
+          simloop_reset(&loop);
           SDL_SetRenderDrawColor(renderer, 0, 0, 0, SDL_ALPHA_OPAQUE);
           SDL_RenderClear(renderer);
           SDL_RenderPresent(renderer);
@@ -211,58 +210,15 @@ int main(int argc, char **argv) {
      * the capture.
      */
 
-    double curdist = vec2d_dist_r(&game_x.chauf.pos, &game_x.ped.pos);
-    game_over = curdist <= capture_radius;
-
-    if (!game_over) {
-      dynsys_step(&game, TIMESTEP);
-    }
+    simloop_advance(&loop, &game, game_desc.done);
   }
 
   /* Release resources */
 
+  dynsys_free(&game);
   SDL_DestroyRenderer(renderer);
   SDL_DestroyWindow(window);
   SDL_Quit();
 
   return EXIT_SUCCESS;
 }
-
-static void player_f(struct player *p, double vel, double dt) {
-  p->pos.x += dt * vel * sin(p->heading);
-  p->pos.y += dt * vel * cos(p->heading);
-}
-
-static void game_f(void *x, double dt) {
-  struct game *game = (struct game *)x;
-  player_f(&game->chauf, chauffeur_vel, dt);
-  player_f(&game->ped, pedestrian_vel, dt);
-}
-
-static void game_u(void *x, double dt) {
-  struct game *game = (struct game *)x;
-  static double t = 0;
-  double phi;
-  double rho = 0;
-  double sw = cos(rho + t) - cos(rho);
-
-  /* TODO: optimal chauffeur strategy */
-  if (f_is_zero(sw, 0.05)) {
-    phi = 0;
-  } else if (sw < 0.0) {
-    phi = -1;
-  } else {
-    phi = 1;
-  }
-
-  /* TODO: optimal evader strategy */
-  game->ped.heading = rho + t;
-  game->chauf.heading += dt * (chauffeur_vel / turn_radius) * phi;
-  t += dt;
-}
-
-/* Running cost of the game is time to capture */
-static double game_g(const void *x, double dt) {
-  unused(x);
-  return dt;
-}
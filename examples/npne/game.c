@@ -0,0 +1,355 @@
+/* This implementation is based on the paper titled "Multiple Pursuer Multiple
+ * Evader Differential Games". Specifically, the N = M PE game
+ * described in Section IV-A.
+ *
+ * @ARTICLE{9122473,
+ * author={Garcia, Eloy and Casbeer, David W. and Von Moll, Alexander and
+ * Pachter, Meir},
+ * journal={IEEE Transactions on Automatic Control},
+ * title={Multiple Pursuer Multiple Evader Differential Games},
+ * year={2021},
+ * volume={66},
+ * number={5},
+ * pages={2345-2350},
+ * keywords={Games;State feedback;Government;Aerospace
+ * electronics;Switches;Weapons;Autonomous systems;intelligent control;optimal
+ * control},
+ * doi={10.1109/TAC.2020.3003840}}
+ */
+
+#include <assert.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "3dtools.h"
+#include "dynsys.h"
+#include "dynsys_stepper.h"
+#include "game.h"
+#include "trig.h"
+#include "utils.h"
+
+/* Game dynamics */
+
+#define a(g, i, j) ((g)->evaders[j].vel / (g)->pursuers[i].vel)
+
+static void game_d(const void *x, real_t *dxdt);
+static size_t game_vars(void *x, real_t **vars);
+static void game_u(void *x, double t, double dt, void *ctx);
+static bool game_done(const void *x);
+static double game_event(const void *x);
+static double game_event_rate(const void *x);
+static bool game_init(void *x, double w, double h, rng_t *rng);
+static void game_free(void *x);
+static void game_copy(void *dst, const void *src);
+static size_t game_save(const void *x, void *buf);
+static void game_restore(void *x, const void *buf);
+
+DYNSYS_DEFINE_STEPPER(game_step, game_d, game_u, NULL, game_event)
+
+static const game_param_t game_params[] = {
+    GAME_PARAM(struct game, n, PARAM_SIZE, 2),
+    GAME_PARAM(struct game, capture_radius, PARAM_REAL, 0.0),
+    GAME_PARAM(struct game, p_vel_min, PARAM_DOUBLE, P_VEL_MIN),
+    GAME_PARAM(struct game, p_vel_max, PARAM_DOUBLE, P_VEL_MAX),
+    GAME_PARAM(struct game, e_vel_min, PARAM_DOUBLE, E_VEL_MIN),
+    GAME_PARAM(struct game, e_vel_max, PARAM_DOUBLE, E_VEL_MAX),
+    GAME_PARAM(struct game, assign_period, PARAM_DOUBLE, 0.0),
+    GAME_PARAM(struct game, exhaustive, PARAM_SIZE, 0),
+};
+
+const game_desc_t game_desc = {
+    .name = "npne",
+    .size = sizeof(struct game),
+    .dt = TIMESTEP,
+    .params = game_params,
+    .n_params = sizeof(game_params) / sizeof(game_params[0]),
+    .init = game_init,
+    .free = game_free,
+    .copy = game_copy,
+    .save = game_save,
+    .restore = game_restore,
+    .f = NULL,
+    .d = game_d,
+    .vars = game_vars,
+    .agent_vars = sizeof(struct agent) / sizeof(real_t),
+    .method = INTEGRATOR_EULER,
+    .step = game_step,
+    .u = game_u,
+    .g = NULL,
+    .q = NULL,
+    .done = game_done,
+    .event = game_event,
+    .event_rate = game_event_rate,
+    .batch = NULL,
+};
+
+/* Agents are stored as consecutive scalars, so each field is drawn for all of
+ * them at once
+ */
+#define AGENT_STRIDE (sizeof(struct agent) / sizeof(real_t))
+
+void game_randinit(struct game *g, double w, double h, rng_t *rng) {
+  rng_fill_strided(rng, &g->agents[0].pos.x, 2 * g->n, AGENT_STRIDE, 0, w);
+  rng_fill_strided(rng, &g->agents[0].pos.y, 2 * g->n, AGENT_STRIDE, 0, h);
+  rng_fill_strided(rng, &g->pursuers[0].vel, g->n, AGENT_STRIDE,
+                   g->p_vel_min, g->p_vel_max);
+  rng_fill_strided(rng, &g->evaders[0].vel, g->n, AGENT_STRIDE, g->e_vel_min,
+                   g->e_vel_max);
+
+  for (size_t i = 0; i < 2 * g->n; i++) g->agents[i].heading = 0.0;
+  for (size_t p = 0; p < g->n; p++) g->assign[p] = p;
+  g->solver.solved = false;
+  g->assign_next = 0.0;
+  game_u(g, 0.0, 0.0, NULL); /* Start out on the optimal headings */
+}
+
+/* Allocates the agents and the assignment search, then assigns random initial
+ * conditions. Heading is not relevant since it can be changed instantaneously.
+ * Velocities are random within a range.
+ */
+static bool game_init(void *x, double w, double h, rng_t *rng) {
+  struct game *g = (struct game *)x;
+
+  if (g->n == 0) return false;
+
+  g->agents = malloc(sizeof(struct agent) * 2 * g->n);
+  g->assign = malloc(sizeof(size_t) * g->n);
+
+  /* The search holds the positions of all agents as a batch, followed by the
+   * value of every pair of pursuer and evader. The controller then reuses the
+   * positions for the directions of the agents.
+   */
+
+  g->search = malloc(sizeof(real_t) * (4 * g->n + g->n * g->n));
+  if (!assign_init(&g->solver, g->n) || g->agents == NULL ||
+      g->assign == NULL || g->search == NULL) {
+    game_free(g);
+    return false;
+  }
+
+  g->pursuers = g->agents;
+  g->evaders = g->agents + g->n;
+
+  game_randinit(g, w, h, rng);
+  return true;
+}
+
+static void game_free(void *x) {
+  struct game *g = (struct game *)x;
+  assign_free(&g->solver);
+  free(g->search);
+  free(g->assign);
+  free(g->agents);
+}
+
+static void game_copy(void *dst, const void *src) {
+  struct game *d = (struct game *)dst;
+  const struct game *s = (const struct game *)src;
+  assert(d->n == s->n);
+  memcpy(d->agents, s->agents, sizeof(struct agent) * 2 * s->n);
+  memcpy(d->assign, s->assign, sizeof(size_t) * s->n);
+  assign_copy(&d->solver, &s->solver);
+  d->capture_radius = s->capture_radius;
+  d->p_vel_min = s->p_vel_min;
+  d->p_vel_max = s->p_vel_max;
+  d->e_vel_min = s->e_vel_min;
+  d->e_vel_max = s->e_vel_max;
+  d->assign_period = s->assign_period;
+  d->assign_next = s->assign_next;
+}
+
+/* Snapshots hold the assignment, which the controller keeps from one search to
+ * the next, and the solution the solver's next search starts from, on top of
+ * the game struct and the agents.
+ */
+static size_t game_save(const void *x, void *buf) {
+  const struct game *g = (const struct game *)x;
+  size_t size = sizeof(size_t) * g->n;
+  if (buf != NULL) {
+    memcpy(buf, g->assign, size);
+    buf = (unsigned char *)buf + size;
+  }
+  return size + assign_save(&g->solver, buf);
+}
+
+static void game_restore(void *x, const void *buf) {
+  struct game *g = (struct game *)x;
+  memcpy(g->assign, buf, sizeof(size_t) * g->n);
+  assign_restore(&g->solver,
+                 (const unsigned char *)buf + sizeof(size_t) * g->n);
+}
+
+/* The game ends when all pursuers of the optimal assignment are within the
+ * capture radius of their evaders.
+ */
+static bool game_done(const void *x) {
+  const struct game *g = (const struct game *)x;
+
+  for (size_t p = 0; p < g->n; p++) {
+    real_t dist =
+        vec2d_dist_r(&g->pursuers[p].pos, &g->evaders[g->assign[p]].pos);
+    if (dist > g->capture_radius &&
+        !f_is_equal(dist, g->capture_radius, CAPTURE_TOLERANCE)) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+/* Capture happens as the farthest pursuer of the optimal assignment comes
+ * within the capture radius of its evader, up to the capture tolerance.
+ */
+static double game_event(const void *x) {
+  const struct game *g = (const struct game *)x;
+  real_t farthest = -INFINITY;
+
+  for (size_t p = 0; p < g->n; p++) {
+    real_t dist =
+        vec2d_dist_r(&g->pursuers[p].pos, &g->evaders[g->assign[p]].pos);
+    if (dist > farthest) farthest = dist;
+  }
+
+  return farthest - (g->capture_radius + CAPTURE_TOLERANCE);
+}
+
+/* No pair closes in faster than the fastest pursuer and evader together */
+static double game_event_rate(const void *x) {
+  const struct game *g = (const struct game *)x;
+  return g->p_vel_max + g->e_vel_max;
+}
+
+/* Dynamics for a holonomic agent. Headings only change with the controls, so
+ * the velocities are constant over a step and Euler integration is exact.
+ */
+
+static void agent_d(const struct agent *a, real_t *dxdt) {
+  real_t s, c;
+  real_sincos(a->heading, &s, &c);
+  dxdt[0] = a->vel * c;
+  dxdt[1] = a->vel * s;
+  dxdt[2] = 0.0;
+  dxdt[3] = 0.0;
+}
+
+/* The agents array is integrated as a whole */
+static size_t game_vars(void *x, real_t **vars) {
+  struct game *game = (struct game *)x;
+  *vars = (real_t *)game->agents;
+  return game->n * 2 * (sizeof(struct agent) / sizeof(real_t));
+}
+
+static void game_d(const void *x, real_t *dxdt) {
+  const struct game *game = (const struct game *)x;
+  size_t stride = sizeof(struct agent) / sizeof(real_t);
+  for (size_t i = 0; i < game->n * 2; i++) {
+    agent_d(&game->agents[i], &dxdt[i * stride]);
+  }
+}
+
+static real_t y_ij(size_t i, size_t j, real_t dij, struct game *g) {
+  return (g->evaders[j].pos.y - a(g, i, j) * a(g, i, j) * g->pursuers[i].pos.y -
+          a(g, i, j) * dij) /
+         (1 - (a(g, i, j) * a(g, i, j)));
+}
+
+/* Every assignment is made of the same N * N pairs, so the value of each pair
+ * is computed once per search, in y[i * N + j], from the distances between all
+ * pursuers and evaders computed as a batch.
+ */
+static real_t *pair_values(struct game *g) {
+  size_t n = g->n;
+  real_t *pos = g->search;
+  real_t *y = &g->search[4 * n];
+  vec2d_batch_t p = {.x = &pos[0], .y = &pos[n]};
+  vec2d_batch_t e = {.x = &pos[2 * n], .y = &pos[3 * n]};
+
+  for (size_t k = 0; k < n; k++) {
+    p.x[k] = g->pursuers[k].pos.x;
+    p.y[k] = g->pursuers[k].pos.y;
+    e.x[k] = g->evaders[k].pos.x;
+    e.y[k] = g->evaders[k].pos.y;
+  }
+
+  vec2d_batch_dist_pairwise(&p, n, &e, n, y);
+  for (size_t i = 0; i < n; i++) {
+    for (size_t j = 0; j < n; j++) {
+      y[i * n + j] = y_ij(i, j, y[i * n + j], g);
+    }
+  }
+
+  return y;
+}
+
+static void compute_aimpoints(size_t i, size_t j, struct game *g, real_t *xaim,
+                              real_t *yaim) {
+  real_t aij2 = (a(g, i, j) * a(g, i, j));
+  real_t dij = vec2d_dist_r(&g->pursuers[i].pos, &g->evaders[j].pos);
+
+  *xaim = (g->evaders[j].pos.x - aij2 * g->pursuers[i].pos.x) / (1 - aij2);
+  *yaim =
+      (g->evaders[j].pos.y - aij2 * g->pursuers[i].pos.y - a(g, i, j) * dij) /
+      (1 - aij2);
+}
+
+/* Searches all assignments for the one with the largest value. The Hungarian
+ * method finds it in O(N^3), or less starting from the previous search's. The
+ * exhaustive search takes O(N!) at worst, but is kept to verify it.
+ *
+ * NOTE: we assume every pair is feasible
+ */
+static void best_assignment(struct game *game) {
+  const real_t *y = pair_values(game);
+
+  if (game->exhaustive) {
+    assign_search(&game->solver, y, true);
+  } else if (assign_update(&game->solver, y, true) == 0) {
+    return;
+  }
+
+  memcpy(game->assign, game->solver.row_col, sizeof(size_t) * game->n);
+}
+
+/* The assignment search costs more than steering the agents, so it may run at
+ * a lower rate (every `assign_period`) while the headings follow the chosen
+ * assignment at every control update.
+ */
+static void game_u(void *x, double t, double dt, void *ctx) {
+  unused(ctx);
+  struct game *game = (struct game *)x;
+  real_t xaim;
+  real_t yaim;
+
+  /* Notify the game termination logic of the current assignment */
+
+  if (game->assign_period <= 0.0 || t + 0.5 * dt >= game->assign_next) {
+    best_assignment(game);
+    game->assign_next += game->assign_period;
+    if (game->assign_next <= t) game->assign_next = t + game->assign_period;
+  }
+
+  /* Using the best found assignment, compute opt controls: the direction of
+   * every agent towards its aim point, in the same order as the agents, and
+   * then all headings at once
+   */
+
+  real_t *dy = &game->search[0];
+  real_t *dx = &game->search[2 * game->n];
+
+  for (size_t i = 0; i < game->n; i++) {
+    size_t j = game->assign[i];
+
+    compute_aimpoints(i, j, game, &xaim, &yaim);
+    dy[i] = yaim - game->pursuers[i].pos.y;
+    dx[i] = xaim - game->pursuers[i].pos.x;
+    dy[game->n + j] = yaim - game->evaders[j].pos.y;
+    dx[game->n + j] = xaim - game->evaders[j].pos.x;
+  }
+
+  trig_batch_atan2(dy, dx, dy, 2 * game->n);
+  for (size_t k = 0; k < 2 * game->n; k++) {
+    game->agents[k].heading = dy[k];
+  }
+}
@@ -0,0 +1,58 @@
+#ifndef DIFFGAMES_NPNE_GAME_H
+#define DIFFGAMES_NPNE_GAME_H
+
+#include <stddef.h>
+
+#include "3dtools.h"
+#include "assign.h"
+#include "headless.h"
+
+#define TIMESTEP (0.01) /* Fraction of a second */
+
+/* Agents are integrated as an array of scalars, so they only hold scalars */
+
+struct agent {
+  vec2d_t pos;
+  real_t heading;
+  real_t vel;
+};
+
+struct game {
+  struct agent *agents;   /* All agents */
+  struct agent *pursuers; /* Offset into agent array for pursuers */
+  struct agent *evaders;  /* Offset into agent array for evaders */
+  size_t *assign;         /* Evader assigned to each pursuer */
+  assign_t solver;        /* Solver of the assignment problem */
+  real_t *search;         /* Scratch space of the assignment search */
+  size_t n;               /* Value of N = M */
+  real_t capture_radius;  /* Capture radius of pursuers */
+  double p_vel_min;       /* Range of the pursuers' random velocities */
+  double p_vel_max;
+  double e_vel_min;       /* Range of the evaders' random velocities */
+  double e_vel_max;
+  double assign_period;   /* Time between assignment searches, or 0 */
+  double assign_next;     /* Simulated time of the next search */
+  size_t exhaustive;      /* Search all N! assignments instead, if not 0 */
+};
+
+/* Game "constant" parameters */
+
+#define CAPTURE_TOLERANCE (0.08)
+
+/* Default velocity ranges, see the game's parameters */
+
+#define P_VEL_MIN (30.0)
+#define P_VEL_MAX (40.0)
+#define E_VEL_MIN (10.0)
+#define E_VEL_MAX (29.0)
+
+/* Game description for headless simulation */
+
+extern const game_desc_t game_desc;
+
+/* Random initial conditions for x, y positions of all agents, without
+ * re-allocating the game.
+ */
+void game_randinit(struct game *g, double w, double h, rng_t *rng);
+
+#endif // DIFFGAMES_NPNE_GAME_H
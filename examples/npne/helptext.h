@@ -1,23 +1,31 @@
 #define HELP_TEXT \
 "N Pursuers, M Evaders\n\nDESCRIPTION:\n    This game is based on the paper " \
-"Multiple Pursuers Multiple Evader\n    Differential Games\" by Eloy Garcia, " \
-"David W. Casbeer, Alexander Von Moll and\n    Meir Pachter.\n\n    The game " \
-"consists of N pursuers and M evaders, where N = M. The goal of the\n    purs" \
-"uers is to capture the evaders (come within some capture radius distance\n  " \
-"  of the evaders) in the shortest time possible. The evaders aim to avoid\n " \
-"   capture for as long as possible.\n\n    Pursuers are always faster than e" \
-"vaders. All agents have holonomic motion in\n    an infinite 2D plane. The p" \
-"layers are controlled by their optimal control\n    signals from Section IV-" \
-"A of the paper. At run-time, the players are all\n    assigned random initia" \
-"l conditions (start locations and headings), as well\n    as a random veloci" \
-"ty within some allowable range. Pursuer velocities are\n    within [30, 40] " \
-"and evader velocities are within [10, 29].\n\nUSAGE:\n    npme [OPTIONS]\n\n" \
-"OPTIONS:\n    -h          Display this help text.\n    -x <width>  Window wi" \
-"dth in pixels. Default is half screen width.\n    -y <height> Window height " \
-"in pixels. Default is half screen height.\n    -s <scale>  Rendering scale. " \
-"Default 5.\n    -r <radius> Capture radius of the pursuers in meters. Defaul" \
-"t 0.\n    -n <num>    Number of pursuers and evaders. Default 2.\n\nCONTROLS" \
-":\n    This game is visualized using SDL2 and accepts keyboard input.\n\n   " \
-" q           Quit the game.\n    Esc         Quit the game.\n    r          " \
-" Toggle visualization of the pursuer capture radius.\n    Space       Re-see" \
-"d and re-start the game.\n"
+"\"Multiple Pursuers Multiple Evader\n    Differential Games\" by Eloy Garcia" \
+", David W. Casbeer, Alexander Von Moll and\n    Meir Pachter.\n\n    The gam" \
+"e consists of N pursuers and M evaders, where N = M. The goal of the\n    pu" \
+"rsuers is to capture the evaders (come within some capture radius distance\n" \
+"    of the evaders) in the shortest time possible. The evaders aim to avoid" \
+"\n    capture for as long as possible.\n\n    Pursuers are always faster tha" \
+"n evaders. All agents have holonomic motion in\n    an infinite 2D plane. Th" \
+"e players are controlled by their optimal control\n    signals from Section " \
+"IV-A of the paper. At run-time, the players are all\n    assigned random ini" \
+"tial conditions (start locations and headings), as well\n    as a random vel" \
+"ocity within some allowable range. Pursuer velocities are\n    within [30, 4" \
+"0] and evader velocities are within [10, 29].\n\nUSAGE:\n    npme [OPTIONS]" \
+"\n\nOPTIONS:\n    -h          Display this help text.\n    -x <width>  Windo" \
+"w width in pixels. Default is half screen width.\n    -y <height> Window hei" \
+"ght in pixels. Default is half screen height.\n    -s <scale>  Rendering sca" \
+"le. Default 5.\n    -r <radius> Capture radius of the pursuers in meters. De" \
+"fault 0.\n    -n <num>    Number of pursuers and evaders. Default 2.\n    -f" \
+" <factor> Simulation speed as a multiple of real-time, 0 to run as fast\n   " \
+"             as possible. Default 1.\n    -S <seed>   Seed for the initial c" \
+"onditions. Default is current time.\n    -p <file>   Play back a trajectory " \
+"recorded by npne-headless -o <file>\n                instead of simulating a" \
+" game.\n\nCONTROLS:\n    This game is visualized using SDL2 and accepts keyb" \
+"oard input.\n\n    q           Quit the game.\n    Esc         Quit the game" \
+".\n    r           Toggle visualization of the pursuer capture radius.\n    " \
+"Space       Re-seed and re-start the game.\n\n    When playing back a record" \
+"ed trajectory:\n\n    Space       Pause or resume playback.\n    Left/Right " \
+" Seek back/forward by one second.\n    Up/Down     Double/halve the playback" \
+" speed.\n    Home/End    Jump to the start/end of the recording.\n    0-9   " \
+"      Jump to 0%, 10%, ..., 90% of the recording.\n"
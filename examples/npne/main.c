@@ -1,21 +1,4 @@
-/* This implementation is based on the paper titled "Multiple Pursuer Multiple
- * Evader Differential Games". Specifically, the N = M PE game
- * described in Section IV-A.
- *
- * @ARTICLE{9122473,
- * author={Garcia, Eloy and Casbeer, David W. and Von Moll, Alexander and
- * Pachter, Meir},
- * journal={IEEE Transactions on Automatic Control},
- * title={Multiple Pursuer Multiple Evader Differential Games},
- * year={2021},
- * volume={66},
- * number={5},
- * pages={2345-2350},
- * keywords={Games;State feedback;Government;Aerospace
- * electronics;Switches;Weapons;Autonomous systems;intelligent control;optimal
- * control},
- * doi={10.1109/TAC.2020.3003840}}
- */
+/* SDL front-end for the N pursuer, N evader game, which lives in game.c */
 
 #include <getopt.h>
 #include <math.h>
@@ -29,72 +12,196 @@
 
 #include "3dtools.h"
 #include "dynsys.h"
+#include "game.h"
+#include "headless.h"
 #include "helptext.h"
+#include "recorder.h"
 #include "render.h"
+#include "simthread.h"
 #include "utils.h"
 
-#define TIMESTEP (0.01) /* Fraction of a second */
-
 const char WINDOW_NAME[] = "N Pursuers, M Evaders";
 
-struct pair {
-  size_t i; /* Pursuer i */
-  size_t j; /* Evader j */
-};
+#define CIRCLE_POINTS (10)
 
-struct agent {
-  vec2d_t pos;
-  double heading;
-  double vel;
-};
+/* Replay controls */
 
-struct game {
-  struct agent *agents;      /* All agents */
-  struct agent *pursuers;    /* Offset into agent array for pursuers */
-  struct agent *evaders;     /* Offset into agent array for evaders */
-  struct pair **assignments; /* All possible assignments */
-  size_t n_assign;           /* Number of possible assignments */
-  size_t n;                  /* Value of N = M */
-  double capture_radius;     /* Capture radius of pursuers */
-};
+#define SEEK_STEP (1.0)        /* Seconds skipped by the arrow keys */
+#define SPEED_MIN (1.0 / 64.0) /* Slowest playback speed */
+#define SPEED_MAX (64.0)       /* Fastest playback speed */
 
-/* Game "constant" parameters */
+/* Everything the simulation thread needs to restart the game */
 
-#define CAPTURE_TOLERANCE (0.08)
+struct restart_ctx {
+  struct game *x; /* Game state */
+  dynsys_t *s;    /* Dynamic system of the game */
+  double w;       /* Arena width */
+  double h;       /* Arena height */
+  rng_t rng;      /* Generator of new initial conditions */
+};
 
-#define P_VEL_MIN (30.0)
-#define P_VEL_MAX (40.0)
-#define E_VEL_MIN (10.0)
-#define E_VEL_MAX (29.0)
+static bool game_restart(void *ctx) {
+  struct restart_ctx *r = (struct restart_ctx *)ctx;
+  game_randinit(r->x, r->w, r->h, &r->rng);
+  dynsys_free(r->s);
+  return game_dynsys_init(&game_desc, r->s, r->x);
+}
 
-#define CIRCLE_POINTS (10)
+/* Only the agents are rendered; the number of agents and the capture radius
+ * never change once the game is set up, so they are read from the game state.
+ */
+static void game_snapshot(void *dst, const void *state) {
+  const struct game *g = (const struct game *)state;
+  memcpy(dst, g->agents, 2 * g->n * sizeof(struct agent));
+}
 
-/* Used for terminal condition: determine when all pairs have distance of 0 */
-static size_t opt_assign = 0;
+/* Draws pursuers (red) and evaders (green), with the pursuers' capture radius
+ * (white) if asked to. The screen is cleared with semi-transparency so that a
+ * trail appears.
+ */
+static void draw_agents(SDL_Renderer *renderer, const SDL_Rect *screen,
+                        const struct agent *pursuers, size_t n,
+                        double capture_radius, bool show_radius) {
+  const struct agent *evaders = pursuers + n;
+
+  SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+  SDL_SetRenderDrawColor(renderer, 0, 0, 0, 10);
+  SDL_RenderFillRect(renderer, screen);
+
+  SDL_SetRenderDrawColor(renderer, 255, 0, 0, SDL_ALPHA_OPAQUE);
+  for (size_t i = 0; i < n; i++) {
+    render_vec2d(renderer, &pursuers[i].pos);
+  }
 
-/* Game dynamics */
+  SDL_SetRenderDrawColor(renderer, 0, 255, 0, SDL_ALPHA_OPAQUE);
+  for (size_t j = 0; j < n; j++) {
+    render_vec2d(renderer, &evaders[j].pos);
+  }
 
-#define a(g, i, j) ((g)->evaders[j].vel / (g)->pursuers[i].vel)
+  show_radius = show_radius && !f_is_zero(capture_radius, 0.01);
+  if (show_radius) {
+    SDL_SetRenderDrawColor(renderer, 255, 255, 255, SDL_ALPHA_OPAQUE);
+    for (size_t i = 0; i < n; i++) {
+      render_circle(renderer, &pursuers[i].pos, capture_radius, CIRCLE_POINTS);
+    }
+  }
 
-static void game_f(void *x, double dt);
-static void game_u(void *x, double dt);
+  SDL_RenderPresent(renderer);
 
-static void game_randinit(struct game *g, SDL_DisplayMode *dm, double scale) {
-  for (size_t i = 0; i < 2 * g->n; i++) {
-    g->agents[i].pos.x = randval(0, dm->w / scale);
-    g->agents[i].pos.y = randval(0, dm->h / scale);
+  /* Clear pursuer capture radius before next slide */
 
-    if (i < g->n) {
-      g->agents[i].vel = randval(P_VEL_MIN, P_VEL_MAX);
-    } else {
-      g->agents[i].vel = randval(E_VEL_MIN, E_VEL_MAX);
+  if (show_radius) {
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, SDL_ALPHA_OPAQUE);
+    for (size_t i = 0; i < n; i++) {
+      render_circle(renderer, &pursuers[i].pos, capture_radius, CIRCLE_POINTS);
     }
   }
 }
 
-static size_t n_combos(size_t n) {
-  if (n == 2) return 2;
-  return n * n_combos(n - 1);
+static void clear_screen(SDL_Renderer *renderer) {
+  SDL_SetRenderDrawColor(renderer, 0, 0, 0, SDL_ALPHA_OPAQUE);
+  SDL_RenderClear(renderer);
+  SDL_RenderPresent(renderer);
+}
+
+/* Plays back a recorded game. Records are looked up by time straight from the
+ * mapped file, so seeking anywhere costs the same as playing; the game itself
+ * is never simulated.
+ */
+static void replay(SDL_Renderer *renderer, const SDL_Rect *screen,
+                   const trajectory_t *traj, double capture_radius) {
+  size_t n = traj->hdr->n_agents / 2;
+  double t_start = trajectory_time(traj, 0);
+  double t_end = trajectory_time(traj, traj->n - 1);
+  double t = t_start;
+  double speed = 1.0;
+  double last = headless_now();
+  bool running = true;
+  bool paused = false;
+  bool show_capture_radius = false;
+  SDL_Event event;
+
+  while (running) {
+    double seek = t;
+
+    /* Check for input events */
+
+    while (SDL_PollEvent(&event)) {
+
+      switch (event.type) {
+
+      case SDL_QUIT:
+        running = false;
+        break;
+
+      case SDL_KEYDOWN:
+        switch (event.key.keysym.sym) {
+
+        case SDLK_ESCAPE:
+        case SDLK_q:
+          running = false;
+          break;
+        case SDLK_r:
+          show_capture_radius = !show_capture_radius;
+          break;
+        case SDLK_SPACE:
+          paused = !paused;
+          break;
+        case SDLK_LEFT:
+          seek -= SEEK_STEP;
+          break;
+        case SDLK_RIGHT:
+          seek += SEEK_STEP;
+          break;
+        case SDLK_UP:
+          speed = fmin(speed * 2.0, SPEED_MAX);
+          break;
+        case SDLK_DOWN:
+          speed = fmax(speed / 2.0, SPEED_MIN);
+          break;
+        case SDLK_HOME:
+          seek = t_start;
+          break;
+        case SDLK_END:
+          seek = t_end;
+          break;
+
+        default:
+          /* Number keys jump to tenths of the recording */
+
+          if (event.key.keysym.sym >= SDLK_0 &&
+              event.key.keysym.sym <= SDLK_9) {
+            seek = t_start + (event.key.keysym.sym - SDLK_0) / 10.0 *
+                                 (t_end - t_start);
+          }
+          break;
+        }
+        break;
+
+      default:
+        break;
+      }
+    }
+
+    /* Trails would jump across the screen when seeking */
+
+    if (seek != t) {
+      t = seek;
+      clear_screen(renderer);
+    }
+
+    double now = headless_now();
+    if (!paused) t += (now - last) * speed;
+    last = now;
+    t = fmax(t_start, fmin(t, t_end));
+
+    /* Agents are only made of scalars, so records hold them as they are */
+
+    const struct agent *agents =
+        (const struct agent *)trajectory_vars(traj, trajectory_seek(traj, t));
+    draw_agents(renderer, screen, agents, n, capture_radius,
+                show_capture_radius || t >= t_end);
+  }
 }
 
 int main(int argc, char **argv) {
@@ -107,14 +214,19 @@ int main(int argc, char **argv) {
   bool running = true;
   bool show_capture_radius = false;
   bool game_over = false;
+  unsigned long gen = 0;
+  const char *replay_path = NULL;
+  trajectory_t traj;
+  unsigned seed = time(NULL);
+  rng_t rng;
+  double rate = 1.0;
 
   /* Default values */
 
-  game_x.n = 2;
-  game_x.capture_radius = 0.0;
+  game_params_default(&game_desc, &game_x);
 
   int c;
-  while ((c = getopt(argc, argv, ":hx:y:s:r:n:")) != -1) {
+  while ((c = getopt(argc, argv, ":hx:y:s:r:n:f:p:S:")) != -1) {
     switch (c) {
     case 'h':
       puts(HELP_TEXT);
@@ -139,6 +251,19 @@ int main(int argc, char **argv) {
         exit(EXIT_FAILURE);
       }
       break;
+    case 'S':
+      seed = strtoul(optarg, NULL, 10);
+      break;
+    case 'f':
+      rate = strtod(optarg, NULL);
+      if (rate < 0) {
+        fprintf(stderr, "Real-time factor must be >= 0.\n");
+        exit(EXIT_FAILURE);
+      }
+      break;
+    case 'p':
+      replay_path = optarg;
+      break;
     case '?':
       fprintf(stderr, "Unknown option -%c\n", optopt);
       exit(EXIT_FAILURE);
@@ -146,6 +271,19 @@ int main(int argc, char **argv) {
     }
   }
 
+  if (replay_path != NULL) {
+    if (!trajectory_open(&traj, replay_path)) {
+      fprintf(stderr, "Couldn't read trajectory file %s.\n", replay_path);
+      exit(EXIT_FAILURE);
+    }
+    if (strcmp(traj.hdr->game, game_desc.name) != 0 ||
+        traj.hdr->agent_vars != sizeof(struct agent) / sizeof(real_t)) {
+      fprintf(stderr, "%s isn't a trajectory of %s.\n", replay_path,
+              game_desc.name);
+      exit(EXIT_FAILURE);
+    }
+  }
+
   /* Set up OpenGL parameters */
 
   SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, SDL_GL_CONTEXT_PROFILE_CORE);
@@ -175,93 +313,51 @@ int main(int argc, char **argv) {
       window, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC);
   SDL_RenderSetScale(renderer, scale, scale);
 
-  /* Initialize game */
+  /* Play back a recorded game instead of simulating one */
 
-  game_x.agents = malloc(sizeof(struct agent) * 2 * game_x.n);
-  if (game_x.agents == NULL) {
-    fprintf(stderr, "Couldn't allocate space for agent states.\n");
-    exit(EXIT_FAILURE);
+  if (replay_path != NULL) {
+    replay(renderer, &fullscreen, &traj, game_x.capture_radius);
+    trajectory_close(&traj);
+    SDL_DestroyRenderer(renderer);
+    SDL_DestroyWindow(window);
+    SDL_Quit();
+    return EXIT_SUCCESS;
   }
 
-  game_x.pursuers = game_x.agents;
-  game_x.evaders = game_x.agents + game_x.n;
-
-  /* Calculate the number of possible assignments */
+  /* Initialize game with random initial conditions */
 
-  game_x.n_assign = n_combos(game_x.n);
-  game_x.assignments = malloc(sizeof(struct pair *) * game_x.n_assign);
-  if (game_x.assignments == NULL) {
-    fprintf(stderr, "Couldn't allocate space for assignments.\n");
+  rng_seed(&rng, seed);
+  if (!game_desc.init(&game_x, dm.w / scale, dm.h / scale, &rng)) {
+    fprintf(stderr, "Couldn't allocate space for the game.\n");
     exit(EXIT_FAILURE);
   }
-
-  /* Each assignment must have space for N pairs */
-
-  for (size_t i = 0; i < game_x.n_assign; i++) {
-    game_x.assignments[i] = malloc(sizeof(struct pair) * game_x.n);
-    if (game_x.assignments[i] == NULL) {
-      fprintf(stderr, "Couldn't allocate space for assignments (%u).\n", i);
-      exit(EXIT_FAILURE);
-    }
-  }
-
-  /* Compute all possible assignments to populate array
-   * TODO: this is an absolutely garbage method to generate combinations
-   */
-
-  size_t e;
-  for (size_t a = 0; a < game_x.n_assign; a++) {
-
-  retry_ass:
-    for (size_t p = 0; p < game_x.n; p++) {
-      /* P is the current pair index, and also always the pursuer index.
-       *
-       * Now we must choose the evader index such that no evader
-       * repeats twice in this assignment, and so that the assignment is
-       * unique.
-       */
-      game_x.assignments[a][p].i = p;
-    retry_e:
-      e = randval(0, game_x.n);
-      for (size_t e1 = 0; e1 < p; e1++) {
-        if (game_x.assignments[a][e1].j == e) goto retry_e;
-      }
-      game_x.assignments[a][p].j = e;
-    }
-
-    /* Check that this assignment hasn't been found yet */
-
-    for (size_t a1 = 0; a1 < a; a1++) {
-      if (memcmp(game_x.assignments[a], game_x.assignments[a1],
-                 sizeof(struct pair) * game_x.n) == 0) {
-        goto retry_ass;
-      }
-    }
+  if (!game_dynsys_init(&game_desc, &game, &game_x)) {
+    fprintf(stderr, "Couldn't initialize the game.\n");
+    exit(EXIT_FAILURE);
   }
 
-#if CONFIG_DEBUG
-  /* Print out all pairs for debugging */
-
-  for (size_t a = 0; a < game_x.n_assign; a++) {
-    printf("[%u] -> ", a);
-    for (size_t p = 0; p < game_x.n; p++) {
-      printf("(%u, %u) ", game_x.assignments[a][p].i,
-             game_x.assignments[a][p].j);
-    }
-    printf("\n");
+  /* Simulate on a separate thread, so that large games don't stall input */
+
+  struct restart_ctx ctx = {
+      .x = &game_x, .s = &game, .w = dm.w / scale, .h = dm.h / scale,
+      .rng = rng};
+  simthread_cfg_t cfg = {
+      .s = &game,
+      .done = game_desc.done,
+      .dt = TIMESTEP,
+      .rate = rate,
+      .snap_size = 2 * game_x.n * sizeof(struct agent),
+      .snap = game_snapshot,
+      .restart = game_restart,
+      .ctx = &ctx,
+  };
+  simthread_t sim;
+  if (!simthread_start(&sim, &cfg)) {
+    fprintf(stderr, "Couldn't start the simulation thread.\n");
+    exit(EXIT_FAILURE);
   }
-#endif
 
-  /* Random initial conditions for x, y positions of all agents. Heading
-   * is not relevant since it can be changed instantaneously. Velocities are
-   * random within a range.
-   */
-
-  srand(time(NULL));
-  game_randinit(&game_x, &dm, scale);
-  dynsys_init(&game, &game_x, game_f, game_u, NULL, NULL);
-
-  /* Simulation loop */
+  /* Render loop */
 
   while (running) {
 
@@ -286,11 +382,8 @@ int main(int argc, char **argv) {
           show_capture_radius = !show_capture_radius;
           break;
         case SDLK_SPACE:
-          game_randinit(&game_x, &dm, scale);
-          dynsys_init(&game, &game_x, game_f, game_u, NULL, NULL);
-          SDL_SetRenderDrawColor(renderer, 0, 0, 0, SDL_ALPHA_OPAQUE);
-          SDL_RenderClear(renderer);
-          SDL_RenderPresent(renderer);
+          gen = simthread_restart(&sim);
+          clear_screen(renderer);
           break;
 
         default:
@@ -303,165 +396,33 @@ int main(int argc, char **argv) {
       }
     }
 
-    /* Clear screen to black with semi-transparency so trail appears */
-
-    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
-    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 10);
-    SDL_RenderFillRect(renderer, &fullscreen);
-
-    /* Draw pursuers in red */
-
-    SDL_SetRenderDrawColor(renderer, 255, 0, 0, SDL_ALPHA_OPAQUE);
-
-    for (size_t i = 0; i < game_x.n; i++) {
-      render_vec2d(renderer, &game_x.pursuers[i].pos);
-    }
-
-    /* Draw evaders in green */
-
-    SDL_SetRenderDrawColor(renderer, 0, 255, 0, SDL_ALPHA_OPAQUE);
-
-    for (size_t j = 0; j < game_x.n; j++) {
-      render_vec2d(renderer, &game_x.evaders[j].pos);
-    }
-
-    /* Draw pursuer capture radius in white */
-
-    if ((show_capture_radius || game_over) &&
-        !f_is_zero(game_x.capture_radius, 0.01)) {
-      SDL_SetRenderDrawColor(renderer, 255, 255, 255, SDL_ALPHA_OPAQUE);
-
-      for (size_t i = 0; i < game_x.n; i++) {
-        render_circle(renderer, &game_x.pursuers[i].pos, game_x.capture_radius,
-                      CIRCLE_POINTS);
-      }
-    }
-
-    /* Show what was drawn */
-
-    SDL_RenderPresent(renderer);
-
-    /* Clear pursuer capture radius before next slide */
-
-    if ((show_capture_radius || game_over) &&
-        !f_is_zero(game_x.capture_radius, 0.01)) {
-      SDL_SetRenderDrawColor(renderer, 0, 0, 0, SDL_ALPHA_OPAQUE);
-      for (size_t i = 0; i < game_x.n; i++) {
-        render_circle(renderer, &game_x.pursuers[i].pos, game_x.capture_radius,
-                      CIRCLE_POINTS);
-      }
+    if (atomic_load(&sim.failed)) {
+      fprintf(stderr, "Couldn't initialize the game.\n");
+      exit(EXIT_FAILURE);
     }
 
-    /* Advance simulation until a capture occurs */
+    /* Draw the newest snapshot, unless it predates a restart */
 
-    game_over = true;
-    for (size_t p = 0; p < game_x.n; p++) {
-      struct pair pair = game_x.assignments[opt_assign][p];
-      double dist = vec2d_dist_r(&game_x.pursuers[pair.i].pos,
-                                 &game_x.evaders[pair.j].pos);
-      if (dist > game_x.capture_radius &&
-          !f_is_equal(dist, game_x.capture_radius, CAPTURE_TOLERANCE)) {
-        game_over = false;
-        break;
-      }
+    const simthread_snap_t *snap = simthread_latest(&sim);
+    if (snap->gen != gen) {
+      SDL_Delay(1);
+      continue;
     }
+    const struct agent *pursuers = (const struct agent *)snap->data;
+    game_over = snap->over;
 
-    if (!game_over) {
-      dynsys_step(&game, TIMESTEP);
-    }
+    draw_agents(renderer, &fullscreen, pursuers, game_x.n,
+                game_x.capture_radius, show_capture_radius || game_over);
   }
 
   /* Release resources */
 
-  for (size_t i = 0; i < game_x.n_assign; i++) {
-    free(game_x.assignments[i]);
-  }
-  free(game_x.assignments);
-  free(game_x.agents);
+  simthread_stop(&sim);
+  dynsys_free(&game);
+  game_desc.free(&game_x);
   SDL_DestroyRenderer(renderer);
   SDL_DestroyWindow(window);
   SDL_Quit();
 
   return EXIT_SUCCESS;
 }
-
-/* Dynamics for a holonomic agent */
-
-static void agent_f(struct agent *a, double dt) {
-  a->pos.x += dt * a->vel * cos(a->heading);
-  a->pos.y += dt * a->vel * sin(a->heading);
-}
-
-static void game_f(void *x, double dt) {
-  struct game *game = (struct game *)x;
-  for (size_t i = 0; i < game->n * 2; i++) {
-    agent_f(&game->agents[i], dt);
-  }
-}
-
-static double y_ij(size_t i, size_t j, struct game *g) {
-  return (g->evaders[j].pos.y - a(g, i, j) * a(g, i, j) * g->pursuers[i].pos.y -
-          a(g, i, j) * vec2d_dist_r(&g->pursuers[i].pos, &g->evaders[j].pos)) /
-         (1.0 - (a(g, i, j) * a(g, i, j)));
-}
-
-/* NOTE: we assume every pair is feasible */
-static double y_s(struct game *g, size_t a) {
-  double ys = 0.0;
-  for (size_t p = 0; p < g->n; p++) {
-    ys += y_ij(g->assignments[a][p].i, g->assignments[a][p].j, g);
-  }
-  return ys;
-}
-
-static void compute_aimpoints(size_t i, size_t j, struct game *g, double *xaim,
-                              double *yaim) {
-  double aij2 = (a(g, i, j) * a(g, i, j));
-  double dij = vec2d_dist_r(&g->pursuers[i].pos, &g->evaders[j].pos);
-
-  *xaim = (g->evaders[j].pos.x - aij2 * g->pursuers[i].pos.x) / (1.0 - aij2);
-  *yaim =
-      (g->evaders[j].pos.y - aij2 * g->pursuers[i].pos.y - a(g, i, j) * dij) /
-      (1.0 - aij2);
-}
-
-static void game_u(void *x, double dt) {
-  unused(dt);
-  struct game *game = (struct game *)x;
-  double xaim;
-  double yaim;
-  double y_s_max = -INFINITY;
-  double y_s_cur;
-  size_t a_max;
-  size_t i;
-  size_t j;
-
-  for (size_t a = 0; a < game->n_assign; a++) {
-    /* Record the largest value and corresponding assignment set */
-
-    y_s_cur = y_s(game, a);
-    if (y_s_cur > y_s_max) {
-      y_s_max = y_s_cur;
-      a_max = a;
-    }
-  }
-
-  /* Notify the game termination logic of the current assignment */
-
-  opt_assign = a_max;
-
-  /* Using the best found value and assignment, compute opt controls */
-
-  for (size_t pidx = 0; pidx < game->n; pidx++) {
-    i = game->assignments[a_max][pidx].i;
-    j = game->assignments[a_max][pidx].j;
-
-    /* Compute optimal headings */
-
-    compute_aimpoints(i, j, game, &xaim, &yaim);
-    game->pursuers[i].heading =
-        atan2(yaim - game->pursuers[i].pos.y, xaim - game->pursuers[i].pos.x);
-    game->evaders[j].heading =
-        atan2(yaim - game->evaders[j].pos.y, xaim - game->evaders[j].pos.x);
-  }
-}
@@ -0,0 +1,118 @@
+#include <math.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+
+#include "dynsys.h"
+#include "dynsys_stepper.h"
+#include "game.h"
+#include "trig.h"
+#include "utils.h"
+
+static void particle_d(const void *x, real_t *dxdt);
+static size_t particle_vars(void *x, real_t **vars);
+static void particle_u(void *x, double t, double dt, void *ctx);
+static bool particle_done(const void *x);
+static double particle_event(const void *x);
+static double particle_event_rate(const void *x);
+static bool particle_init(void *x, double w, double h, rng_t *rng);
+
+DYNSYS_DEFINE_STEPPER(particle_step, particle_d, particle_u, NULL,
+                      particle_event)
+
+static const game_param_t game_params[] = {
+    GAME_PARAM(struct game, p_vel, PARAM_REAL, 50.0),
+    GAME_PARAM(struct game, capture_radius, PARAM_REAL, 1.0),
+};
+
+const game_desc_t game_desc = {
+    .name = "particle",
+    .size = sizeof(struct game),
+    .dt = TIMESTEP,
+    .params = game_params,
+    .n_params = sizeof(game_params) / sizeof(game_params[0]),
+    .init = particle_init,
+    .free = NULL,
+    .f = NULL,
+    .d = particle_d,
+    .vars = particle_vars,
+    .agent_vars = 2,
+    .method = INTEGRATOR_EULER,
+    .step = particle_step,
+    .u = particle_u,
+    .g = NULL,
+    .q = NULL,
+    .done = particle_done,
+    .event = particle_event,
+    .event_rate = particle_event_rate,
+    .batch = NULL,
+};
+
+/* Random initial conditions for the particle and its target */
+static bool particle_init(void *x, double w, double h, rng_t *rng) {
+  struct game *game = (struct game *)x;
+
+  if (game->p_vel <= 0.0) return false;
+
+  game->ppos.x = rng_uniform(rng, 0, w);
+  game->ppos.y = rng_uniform(rng, 0, h);
+  game->heading = 0.0;
+  game->target.x = rng_uniform(rng, 0, w);
+  game->target.y = rng_uniform(rng, 0, h);
+  particle_u(x, 0.0, 0.0, NULL); /* Start out heading for the target */
+  return true;
+}
+
+/* The particle has caught its target */
+static bool particle_done(const void *x) {
+  const struct game *game = (const struct game *)x;
+  return vec2d_dist_r((vec2d_t *)&game->ppos, (vec2d_t *)&game->target) <=
+         game->capture_radius;
+}
+
+/* The particle reaches the target as their distance drops to the capture
+ * radius.
+ */
+static double particle_event(const void *x) {
+  const struct game *game = (const struct game *)x;
+  return vec2d_dist_r((vec2d_t *)&game->ppos, (vec2d_t *)&game->target) -
+         game->capture_radius;
+}
+
+/* The target stands still, so the distance changes as fast as the particle */
+static double particle_event_rate(const void *x) {
+  const struct game *game = (const struct game *)x;
+  return game->p_vel;
+}
+
+/* Particle dynamics. The heading only changes with the control, so the
+ * velocity is constant over a step and Euler integration is exact.
+ */
+
+static size_t particle_vars(void *x, real_t **vars) {
+  struct game *game = (struct game *)x;
+  *vars = &game->ppos.x;
+  return 2;
+}
+
+static void particle_d(const void *x, real_t *dxdt) {
+  const struct game *game = (const struct game *)x;
+  real_t s, c;
+  real_sincos(game->heading, &s, &c);
+  dxdt[0] = game->p_vel * c;
+  dxdt[1] = game->p_vel * s;
+}
+
+/* Particle control function. Particle will always try to follow the target. */
+
+static void particle_u(void *x, double t, double dt, void *ctx) {
+  unused(t);
+  unused(dt);
+  unused(ctx);
+  struct game *game = (struct game *)x;
+
+  /* Compute a heading which moves towards the target position */
+  real_t dx = game->target.x - game->ppos.x;
+  real_t dy = game->target.y - game->ppos.y;
+  game->heading = real_atan2(dy, dx);
+}
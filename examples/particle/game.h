@@ -0,0 +1,24 @@
+#ifndef DIFFGAMES_PARTICLE_GAME_H
+#define DIFFGAMES_PARTICLE_GAME_H
+
+#include "3dtools.h"
+#include "headless.h"
+
+#define TIMESTEP (0.01)
+
+struct game {
+  vec2d_t ppos;
+  real_t heading;
+  vec2d_t target; /* Position the particle follows, i.e. the mouse */
+
+  /* Game constants */
+
+  real_t p_vel;
+  real_t capture_radius; /* Headless runs end when the target is reached */
+};
+
+/* Game description for headless simulation */
+
+extern const game_desc_t game_desc;
+
+#endif // DIFFGAMES_PARTICLE_GAME_H
@@ -5,6 +5,8 @@
 "ow width in pixels. Default is half screen width.\n    -y <height> Window he" \
 "ight in pixels. Default is half screen height.\n    -s <scale>  Rendering sc" \
 "ale. Default 5.\n    -v <vel>    The particle's (positive) velocity in m/s. " \
-"Default 50.0.\n\nCONTROLS:\n    This game is visualized using SDL2 and accep" \
-"ts keyboard input.\n\n    q           Quit the game.\n    Esc         Quit t" \
-"he game.\n"
+"Default 50.0.\n    -f <factor> Simulation speed as a multiple of real-time, " \
+"0 to run as fast\n                as possible. Default 1.\n    -S <seed>   S" \
+"eed for the initial conditions. Default is current time.\n\nCONTROLS:\n    T" \
+"his game is visualized using SDL2 and accepts keyboard input.\n\n    q      " \
+"     Quit the game.\n    Esc         Quit the game.\n"
@@ -1,32 +1,24 @@
+/* SDL front-end for the particle game, which lives in game.c */
+
 #include <getopt.h>
 #include <math.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <time.h>
 
 #include <SDL2/SDL.h>
 
 #include "dynsys.h"
+#include "game.h"
 #include "helptext.h"
 #include "render.h"
+#include "simloop.h"
 #include "utils.h"
 
-#define TIMESTEP (0.01)
-
 static const char window_name[] = "Particle";
 
 static double scale = 5.0;
-static double p_vel = 50.0;
-
-struct game {
-  vec2d_t ppos;
-  double heading;
-  int mousex;
-  int mousey;
-};
-
-static void particle_f(void *x, double dt);
-static void particle_u(void *x, double dt);
 
 int main(int argc, char **argv) {
   SDL_Event event;
@@ -34,9 +26,16 @@ int main(int argc, char **argv) {
   SDL_DisplayMode tempdm;
   struct game game_x;
   bool running = true;
+  unsigned seed = time(NULL);
+  rng_t rng;
+  double rate = 1.0;
+  int mousex = 0;
+  int mousey = 0;
+
+  game_params_default(&game_desc, &game_x);
 
   int c;
-  while ((c = getopt(argc, argv, ":hx:y:s:v:")) != -1) {
+  while ((c = getopt(argc, argv, ":hx:y:s:v:f:S:")) != -1) {
     switch (c) {
     case 'h':
       puts(HELP_TEXT);
@@ -52,11 +51,21 @@ int main(int argc, char **argv) {
       scale = strtod(optarg, NULL);
       break;
     case 'v':
-      p_vel = strtod(optarg, NULL);
-      if (p_vel <= 0.0) {
+      game_x.p_vel = strtod(optarg, NULL);
+      if (game_x.p_vel <= 0.0) {
         fprintf(stderr, "Invalid velocity.\n");
       }
       break;
+    case 'S':
+      seed = strtoul(optarg, NULL, 10);
+      break;
+    case 'f':
+      rate = strtod(optarg, NULL);
+      if (rate < 0) {
+        fprintf(stderr, "Real-time factor must be >= 0.\n");
+        exit(EXIT_FAILURE);
+      }
+      break;
     case '?':
       fprintf(stderr, "Unknown option -%c\n", optopt);
       exit(EXIT_FAILURE);
@@ -96,11 +105,20 @@ int main(int argc, char **argv) {
 
   /* Set up particle with random initial conditons */
 
-  game_x.ppos.x = randval(0, dm.w / scale);
-  game_x.ppos.y = randval(0, dm.h / scale);
-  game_x.mousex = 0;
-  game_x.mousey = 0;
-  dynsys_t game = DYNSYS_SINIT(&game_x, particle_f, particle_u, NULL, NULL);
+  dynsys_t game;
+  rng_seed(&rng, seed);
+  game_desc.init(&game_x, dm.w / scale, dm.h / scale, &rng);
+  if (!game_dynsys_init(&game_desc, &game, &game_x)) {
+    fprintf(stderr, "Couldn't initialize the game.\n");
+    exit(EXIT_FAILURE);
+  }
+
+  /* The particle keeps following the mouse after catching up with it */
+
+  dynsys_set_event(&game, NULL, DYNSYS_EVENT_TOL);
+
+  simloop_t loop;
+  simloop_init(&loop, TIMESTEP, rate);
 
   while (running) {
 
@@ -152,35 +170,18 @@ int main(int argc, char **argv) {
 
     /* Advance simulation */
 
-    SDL_GetMouseState(&game_x.mousex, &game_x.mousey);
-    dynsys_step(&game, TIMESTEP);
+    SDL_GetMouseState(&mousex, &mousey);
+    game_x.target.x = (double)mousex / scale;
+    game_x.target.y = (double)mousey / scale;
+    simloop_advance(&loop, &game, NULL);
   }
 
   /* Release resources */
 
+  dynsys_free(&game);
   SDL_DestroyRenderer(renderer);
   SDL_DestroyWindow(window);
   SDL_Quit();
 
   return EXIT_SUCCESS;
 }
-
-/* Particle dynamics. */
-
-static void particle_f(void *x, double dt) {
-  struct game *game = (struct game *)x;
-  game->ppos.x += p_vel * dt * cos(game->heading);
-  game->ppos.y += p_vel * dt * sin(game->heading);
-}
-
-/* Particle control function. Particle will always try to follow the cursor. */
-
-static void particle_u(void *x, double dt) {
-  unused(dt);
-  struct game *game = (struct game *)x;
-
-  /* Compute a heading which moves towards the mouse position */
-  double dx = ((double)game->mousex / scale) - game->ppos.x;
-  double dy = ((double)game->mousey / scale) - game->ppos.y;
-  game->heading = atan2(dy, dx);
-}
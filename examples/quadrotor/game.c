@@ -0,0 +1,117 @@
+#include <math.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "dynsys.h"
+#include "dynsys_stepper.h"
+#include "game.h"
+#include "utils.h"
+
+/* Parameters */
+
+#define G ((real_t)9.81)          /* m/s^2 */
+#define QUAD_MASS ((real_t)4.0)   /* kg */
+#define ROTOR_LEN ((real_t)0.315) /* m */
+#define QUAD_J1 ((real_t)0.05)    /* kgm^2 */
+#define QUAD_J2 ((real_t)0.05)    /* kgm^2 */
+#define QUAD_J3 ((real_t)0.10)    /* kgm^2 */
+
+static void quad_d(const void *x, real_t *dxdt);
+static size_t quad_vars(void *x, real_t **vars);
+static void quad_u(void *x, double t, double dt, void *ctx);
+static bool quad_init(void *x, double w, double h, rng_t *rng);
+
+DYNSYS_DEFINE_STEPPER(quad_step, quad_d, quad_u, NULL, NULL)
+
+const game_desc_t game_desc = {
+    .name = "quadrotor",
+    .size = sizeof(struct quadrotor),
+    .dt = TIMESTEP,
+    .params = NULL,
+    .n_params = 0,
+    .init = quad_init,
+    .free = NULL,
+    .f = NULL,
+    .d = quad_d,
+    .vars = quad_vars,
+    .agent_vars = offsetof(struct quadrotor, force) / sizeof(real_t),
+    .method = INTEGRATOR_RK4,
+    .step = quad_step,
+    .u = quad_u,
+    .g = NULL,
+    .q = NULL,
+    .done = NULL,
+    .event = NULL,
+    .batch = NULL,
+};
+
+/* The quadrotor starts at rest in the middle of the arena */
+static bool quad_init(void *x, double w, double h, rng_t *rng) {
+  struct quadrotor *quad = (struct quadrotor *)x;
+  unused(rng);
+
+  memset(quad, 0, sizeof(*quad));
+  quad->pos.x = w / 2;
+  quad->pos.y = h / 2;
+  quad->pos.z = h / 2;
+  return true;
+}
+
+/* Everything but the motor thrusts is integrated */
+static size_t quad_vars(void *x, real_t **vars) {
+  *vars = (real_t *)x;
+  return offsetof(struct quadrotor, force) / sizeof(real_t);
+}
+
+static void quad_d(const void *x, real_t *dxdt) {
+  const struct quadrotor *quad = (const struct quadrotor *)x;
+  struct quadrotor *dquad = (struct quadrotor *)dxdt;
+
+  real_t v1 =
+      (quad->force[0] + quad->force[1] + quad->force[2] + quad->force[3]) /
+      QUAD_MASS;
+  real_t v2 =
+      (-quad->force[0] - quad->force[1] + quad->force[2] + quad->force[3]) /
+      QUAD_J1;
+  real_t v3 =
+      (-quad->force[0] + quad->force[1] + quad->force[2] - quad->force[3]) /
+      QUAD_J2;
+  real_t v4 =
+      (quad->force[0] - quad->force[1] + quad->force[2] - quad->force[3]) /
+      QUAD_J3;
+
+  /* Only the state variables of the derivative are written, it has no room for
+   * the motor thrusts.
+   */
+
+  dquad->pos = quad->vel;
+  dquad->rot = quad->angvel;
+
+  /* The thrust is along the body's z axis, which is the last column of its
+   * rotation. Tilting about the y axis moves the quadrotor along x, so the x
+   * Euler angle is the pitch and the y one the roll.
+   */
+
+  mat3d_t body;
+  mat3d_from_euler(quad->rot.y, quad->rot.x, quad->rot.z, &body);
+  dquad->vel.x = v1 * body.m[0][2];
+  dquad->vel.y = v1 * body.m[1][2];
+  dquad->vel.z = v1 * body.m[2][2] - G;
+  dquad->angvel.x = v2 * ROTOR_LEN;
+  dquad->angvel.y = v3 * ROTOR_LEN;
+  dquad->angvel.z = v4;
+}
+
+static void quad_u(void *x, double t, double dt, void *ctx) {
+  struct quadrotor *quad = (struct quadrotor *)x;
+  unused(dt);
+  unused(ctx);
+
+  /* For fun, sine wave on the motors. Thrust in Newtons */
+
+  for (unsigned i = 0; i < 4; i++) {
+    quad->force[i] = 2.0 * sin(t);
+  }
+}
@@ -0,0 +1,25 @@
+#ifndef DIFFGAMES_QUADROTOR_GAME_H
+#define DIFFGAMES_QUADROTOR_GAME_H
+
+#include "3dtools.h"
+#include "headless.h"
+
+#define TIMESTEP (0.01)
+
+/* The state variables integrated by the dynamic system come first, the motor
+ * thrusts are control variables.
+ */
+
+struct quadrotor {
+  vec3d_t pos;     /* Cartesian position */
+  vec3d_t rot;     /* Euler angles */
+  vec3d_t vel;     /* Cartesian velocity */
+  vec3d_t angvel;  /* Angular velocity */
+  real_t force[4]; /* Motor thrusts */
+};
+
+/* Game description for headless simulation */
+
+extern const game_desc_t game_desc;
+
+#endif // DIFFGAMES_QUADROTOR_GAME_H
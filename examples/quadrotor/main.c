@@ -1,42 +1,23 @@
+/* SDL front-end for the quadrotor model, which lives in game.c */
+
 #include <math.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
-#include <string.h>
 
 #include <SDL2/SDL.h>
 
 #include "dynsys.h"
+#include "game.h"
 #include "render.h"
+#include "simloop.h"
 #include "utils.h"
 
-#define TIMESTEP (0.01)
-
 static const char window_name[] = "Quadrotor Dynamics";
 static const int width = 2048;
 static const int height = 1024;
 static const double scale = 8.0;
 
-struct quadrotor {
-  vec3d_t pos;     /* Cartesian position */
-  vec3d_t rot;     /* Euler angles */
-  vec3d_t vel;     /* Cartesian velocity */
-  vec3d_t angvel;  /* Angular velocity */
-  double force[4]; /* Motor thrusts */
-};
-
-/* Parameters */
-
-#define G (9.81)          /* m/s^2 */
-#define QUAD_MASS (4.0)   /* kg */
-#define ROTOR_LEN (0.315) /* m */
-#define QUAD_J1 (0.05)    /* kgm^2 */
-#define QUAD_J2 (0.05)    /* kgm^2 */
-#define QUAD_J3 (0.10)    /* kgm^2 */
-
-static void quad_f(void *x, double dt);
-static void quad_u(void *x, double dt);
-
 int main(int argc, char **argv) {
   unused(argc);
   unused(argv);
@@ -69,11 +50,15 @@ int main(int argc, char **argv) {
 
   /* Set up particle with initial conditions */
 
-  memset(&quad, 0, sizeof(quad));
-  quad.pos.x = width / (2 * scale);
-  quad.pos.y = height / (2 * scale);
-  quad.pos.z = height / (2 * scale);
-  dynsys_t game = DYNSYS_SINIT(&quad, quad_f, quad_u, NULL, NULL);
+  dynsys_t game;
+  game_desc.init(&quad, width / scale, height / scale, NULL);
+  if (!game_dynsys_init(&game_desc, &game, &quad)) {
+    fprintf(stderr, "Couldn't initialize the game.\n");
+    exit(EXIT_FAILURE);
+  }
+
+  simloop_t loop;
+  simloop_init(&loop, TIMESTEP, 1.0);
 
   /* Render simulation */
 
@@ -133,62 +118,15 @@ int main(int argc, char **argv) {
 
     /* Advance simulation */
 
-    dynsys_step(&game, TIMESTEP);
+    simloop_advance(&loop, &game, NULL);
   }
 
   /* Release resources */
 
+  dynsys_free(&game);
   SDL_DestroyRenderer(renderer);
   SDL_DestroyWindow(window);
   SDL_Quit();
 
   return EXIT_SUCCESS;
 }
-
-static void quad_f(void *x, double dt) {
-  struct quadrotor *quad = (struct quadrotor *)x;
-
-  double v1 =
-      (quad->force[0] + quad->force[1] + quad->force[2] + quad->force[3]) /
-      QUAD_MASS;
-  double v2 =
-      (-quad->force[0] - quad->force[1] + quad->force[2] + quad->force[3]) /
-      QUAD_J1;
-  double v3 =
-      (-quad->force[0] + quad->force[1] + quad->force[2] - quad->force[3]) /
-      QUAD_J2;
-  double v4 =
-      (quad->force[0] - quad->force[1] + quad->force[2] - quad->force[3]) /
-      QUAD_J3;
-
-  quad->pos.x += dt * quad->vel.x;
-  quad->pos.y += dt * quad->vel.y;
-  quad->pos.z += dt * quad->vel.z;
-  quad->rot.x += dt * quad->angvel.x;
-  quad->rot.y += dt * quad->angvel.y;
-  quad->rot.z += dt * quad->angvel.z;
-
-  quad->vel.x += dt * v1 *
-                 (cos(quad->rot.y) * sin(quad->rot.x) * cos(quad->rot.z) +
-                  sin(quad->rot.y) * sin(quad->rot.z));
-  quad->vel.y += dt * v1 *
-                 (sin(quad->rot.x) * sin(quad->rot.z) * cos(quad->rot.y) -
-                  cos(quad->rot.z) * sin(quad->rot.y));
-  quad->vel.z += dt * (v1 * (cos(quad->rot.x) * cos(quad->rot.y)) - G);
-  quad->angvel.x += dt * v2 * ROTOR_LEN;
-  quad->angvel.y += dt * v3 * ROTOR_LEN;
-  quad->angvel.z += dt * v4;
-}
-
-static void quad_u(void *x, double dt) {
-  struct quadrotor *quad = (struct quadrotor *)x;
-  static double t = 0;
-
-  /* For fun, sine wave on the motors. Thrust in Newtons */
-
-  for (unsigned i = 0; i < 4; i++) {
-    quad->force[i] = 2.0 * sin(t);
-  }
-
-  t += dt;
-}
@@ -1,6 +1,12 @@
 #ifndef DIFFGAMES_3DTOOLS_H
 #define DIFFGAMES_3DTOOLS_H
 
+/* Included files */
+
+#include <stddef.h>
+
+#include "real.h"
+
 /* Axis numbering */
 
 enum axis_e {
@@ -12,9 +18,9 @@ enum axis_e {
 /* Vector in 3 dimensions */
 
 typedef struct {
-  double x;
-  double y;
-  double z;
+  real_t x;
+  real_t y;
+  real_t z;
 } vec3d_t;
 
 #define VEC3D_FMT "(%lf, %lf, %lf)"
@@ -22,10 +28,10 @@ typedef struct {
 
 #define VEC3D_SINIT(vx, vy, vz) {.x = (vx), .y = (vy), .z = (vz)}
 #define vec3d_temp(vx, vy) &((vec3d_t)VEC3D_SINIT(vx, vy))
-#define vec3d_get_axis(v, a) (((double *)(v))[(a)])
+#define vec3d_get_axis(v, a) (((real_t *)(v))[(a)])
 
-void vec3d_init(vec3d_t *v, double x, double y, double z);
-vec3d_t vec3d_init_r(double x, double y, double z);
+void vec3d_init(vec3d_t *v, real_t x, real_t y, real_t z);
+vec3d_t vec3d_init_r(real_t x, real_t y, real_t z);
 
 #define vec3d_add(v1, v2, res)                                                 \
   do {                                                                         \
@@ -43,29 +49,29 @@ vec3d_t vec3d_add_r(vec3d_t *v1, vec3d_t *v2);
     (res)->z = (alpha) * (v)->z;                                               \
   } while (0)
 
-vec3d_t vec3d_scale_r(vec3d_t *v, double alpha);
+vec3d_t vec3d_scale_r(vec3d_t *v, real_t alpha);
 
 #define vec3d_dot(v1, v2, res)                                                 \
   do {                                                                         \
     (res) = (v1)->x * (v2->x) + (v1)->y * (v2->y) + (v1)->z * (v2->z);         \
   } while (0)
 
-double vec3d_dot_r(vec3d_t *v1, vec3d_t *v2);
+real_t vec3d_dot_r(vec3d_t *v1, vec3d_t *v2);
 
-void vec3d_rotate(vec3d_t *v, double angle, enum axis_e axis, vec3d_t *res);
-vec3d_t vec3d_rotate_r(vec3d_t *v, double angle, enum axis_e axis);
+void vec3d_rotate(vec3d_t *v, real_t angle, enum axis_e axis, vec3d_t *res);
+vec3d_t vec3d_rotate_r(vec3d_t *v, real_t angle, enum axis_e axis);
 
-void vec3d_norm(vec3d_t *v, double *res);
-double vec3d_norm_r(vec3d_t *v);
+void vec3d_norm(vec3d_t *v, real_t *res);
+real_t vec3d_norm_r(vec3d_t *v);
 
-void vec3d_dist(vec3d_t *v1, vec3d_t *v2, double *res);
-double vec3d_dist_r(vec3d_t *v1, vec3d_t *v2);
+void vec3d_dist(vec3d_t *v1, vec3d_t *v2, real_t *res);
+real_t vec3d_dist_r(vec3d_t *v1, vec3d_t *v2);
 
 /* Vector in 2 dimensions */
 
 typedef struct {
-  double x;
-  double y;
+  real_t x;
+  real_t y;
 } vec2d_t;
 
 #define VEC2D_FMT "(%lf, %lf)"
@@ -73,13 +79,13 @@ typedef struct {
 
 #define VEC2D_SINIT(vx, vy) {.x = (vx), .y = (vy)}
 #define vec2d_temp(vx, vy) &((vec2d_t)VEC2D_SINIT(vx, vy))
-#define vec2d_get_axis(v, a) (((double *)(v))[(a)])
+#define vec2d_get_axis(v, a) (((real_t *)(v))[(a)])
 
-void vec3d_project(vec3d_t *v, double camdist, vec2d_t *res);
-vec2d_t vec3d_project_r(vec3d_t *v, double camdist);
+void vec3d_project(vec3d_t *v, real_t camdist, vec2d_t *res);
+vec2d_t vec3d_project_r(vec3d_t *v, real_t camdist);
 
-vec2d_t vec2d_init_r(double x, double y);
-void vec2d_init(vec2d_t *v, double x, double y);
+vec2d_t vec2d_init_r(real_t x, real_t y);
+void vec2d_init(vec2d_t *v, real_t x, real_t y);
 
 #define vec2d_add(v1, v2, res)                                                 \
   do {                                                                         \
@@ -95,19 +101,159 @@ vec2d_t vec2d_add_r(vec2d_t *v1, vec2d_t *v2);
     (res)->y = (alpha) * (v1)->y;                                              \
   } while (0)
 
-vec2d_t vec2d_scale_r(vec2d_t *v, double alpha);
+vec2d_t vec2d_scale_r(vec2d_t *v, real_t alpha);
 
 #define vec2d_dot(v1, v2, res)                                                 \
   do {                                                                         \
     (res) = (v1)->x * (v2)->x + (v1)->y * (v2)->y;                             \
   } while (0)
 
-double vec2d_dot_r(vec2d_t *v1, vec2d_t *v2);
+real_t vec2d_dot_r(vec2d_t *v1, vec2d_t *v2);
+
+void vec2d_norm(vec2d_t *v, real_t *res);
+real_t vec2d_norm_r(vec2d_t *v);
+
+void vec2d_dist(vec2d_t *v1, vec2d_t *v2, real_t *res);
+real_t vec2d_dist_r(vec2d_t *v1, vec2d_t *v2);
+
+/* Rotations
+ *
+ * A rotation is either a matrix or a unit quaternion. Either one is built once,
+ * from Euler angles or by integrating an angular velocity, and then applied to
+ * any number of vectors without computing trigonometric functions again.
+ *
+ * Euler angles are the roll, pitch and yaw about the x, y and z axes, applied
+ * in this order: R = Rz(yaw) Ry(pitch) Rx(roll). Composing `a` with `b` gives
+ * the rotation which applies `b` first, then `a`. Except for mat3d_apply(),
+ * results may be written over the inputs.
+ */
+
+typedef struct {
+  real_t m[3][3]; /* Rows of the matrix */
+} mat3d_t;
+
+typedef struct {
+  real_t w; /* Scalar part */
+  real_t x; /* Vector part */
+  real_t y;
+  real_t z;
+} quat_t;
+
+#define MAT3D_IDENTITY {.m = {{1, 0, 0}, {0, 1, 0}, {0, 0, 1}}}
+#define QUAT_IDENTITY {.w = 1, .x = 0, .y = 0, .z = 0}
+
+void mat3d_from_euler(real_t roll, real_t pitch, real_t yaw, mat3d_t *res);
+void mat3d_from_quat(const quat_t *q, mat3d_t *res);
+void mat3d_mul(const mat3d_t *a, const mat3d_t *b, mat3d_t *res);
+
+/* The inverse of a rotation matrix is its transpose */
+void mat3d_transpose(const mat3d_t *m, mat3d_t *res);
+
+/* The vector may not be the result, use mat3d_apply_r() to rotate in place */
+#define mat3d_apply(mat, v, res)                                               \
+  do {                                                                         \
+    (res)->x = (mat)->m[0][0] * (v)->x + (mat)->m[0][1] * (v)->y +             \
+               (mat)->m[0][2] * (v)->z;                                        \
+    (res)->y = (mat)->m[1][0] * (v)->x + (mat)->m[1][1] * (v)->y +             \
+               (mat)->m[1][2] * (v)->z;                                        \
+    (res)->z = (mat)->m[2][0] * (v)->x + (mat)->m[2][1] * (v)->y +             \
+               (mat)->m[2][2] * (v)->z;                                        \
+  } while (0)
+
+vec3d_t mat3d_apply_r(const mat3d_t *m, const vec3d_t *v);
+
+void quat_from_euler(real_t roll, real_t pitch, real_t yaw, quat_t *res);
+
+/* Euler angles of a rotation, as the x, y and z of res. The pitch is in
+ * [-pi/2, pi/2], the roll and yaw in [-pi, pi].
+ */
+void quat_to_euler(const quat_t *q, vec3d_t *res);
+
+void quat_mul(const quat_t *a, const quat_t *b, quat_t *res);
+void quat_normalize(quat_t *q);
+
+void quat_apply(const quat_t *q, const vec3d_t *v, vec3d_t *res);
+vec3d_t quat_apply_r(const quat_t *q, const vec3d_t *v);
+
+/* quat_integrate
+ *
+ * Rotates an orientation by a constant angular velocity for some time. The
+ * rotation over the step is exact, rather than a first order approximation,
+ * and the result is normalized, so the orientation doesn't drift away from a
+ * rotation over many steps.
+ *
+ * Parameters:
+ * - q: Orientation, updated in place
+ * - angvel: Angular velocity in radians per second, in the body's own frame
+ * - dt: Length of the step in seconds
+ */
+void quat_integrate(quat_t *q, const vec3d_t *angvel, real_t dt);
+
+/* Batches of vectors
+ *
+ * A batch holds vectors as a structure of arrays, one array of scalars per
+ * axis, so that the batch functions operate on several vectors per
+ * instruction. They use AVX2 when the CPU supports it, and otherwise the
+ * instructions of the build's target (SSE2 on x86-64). Every vector of a batch
+ * is computed exactly like the single-vector functions would compute it, on any
+ * CPU.
+ *
+ * The results may be written over one of the inputs, i.e. `res == v1`, but
+ * must not otherwise overlap them.
+ */
+
+typedef struct {
+  real_t *x;
+  real_t *y;
+} vec2d_batch_t;
+
+typedef struct {
+  real_t *x;
+  real_t *y;
+  real_t *z;
+} vec3d_batch_t;
+
+void vec2d_batch_add(const vec2d_batch_t *v1, const vec2d_batch_t *v2,
+                     vec2d_batch_t *res, size_t n);
+void vec2d_batch_scale(const vec2d_batch_t *v, real_t alpha,
+                       vec2d_batch_t *res, size_t n);
+void vec2d_batch_dot(const vec2d_batch_t *v1, const vec2d_batch_t *v2,
+                     real_t *res, size_t n);
+void vec2d_batch_norm(const vec2d_batch_t *v, real_t *res, size_t n);
+void vec2d_batch_dist(const vec2d_batch_t *v1, const vec2d_batch_t *v2,
+                      real_t *res, size_t n);
+
+/* Distance between every vector of v1 and every vector of v2, in res[i * n2 +
+ * j] for v1[i] and v2[j]
+ */
+void vec2d_batch_dist_pairwise(const vec2d_batch_t *v1, size_t n1,
+                               const vec2d_batch_t *v2, size_t n2,
+                               real_t *res);
+
+void vec3d_batch_add(const vec3d_batch_t *v1, const vec3d_batch_t *v2,
+                     vec3d_batch_t *res, size_t n);
+void vec3d_batch_scale(const vec3d_batch_t *v, real_t alpha,
+                       vec3d_batch_t *res, size_t n);
+void vec3d_batch_dot(const vec3d_batch_t *v1, const vec3d_batch_t *v2,
+                     real_t *res, size_t n);
+void vec3d_batch_norm(const vec3d_batch_t *v, real_t *res, size_t n);
+void vec3d_batch_dist(const vec3d_batch_t *v1, const vec3d_batch_t *v2,
+                      real_t *res, size_t n);
+void vec3d_batch_dist_pairwise(const vec3d_batch_t *v1, size_t n1,
+                               const vec3d_batch_t *v2, size_t n2,
+                               real_t *res);
+
+/* All vectors are rotated by the same angle, about the same axis */
+void vec3d_batch_rotate(const vec3d_batch_t *v, real_t angle, enum axis_e axis,
+                        vec3d_batch_t *res, size_t n);
+void vec3d_batch_project(const vec3d_batch_t *v, real_t camdist,
+                         vec2d_batch_t *res, size_t n);
 
-void vec2d_norm(vec2d_t *v, double *res);
-double vec2d_norm_r(vec2d_t *v);
+/* Applies the same rotation to every vector */
+void mat3d_batch_apply(const mat3d_t *m, const vec3d_batch_t *v,
+                       vec3d_batch_t *res, size_t n);
 
-void vec2d_dist(vec2d_t *v1, vec2d_t *v2, double *res);
-double vec2d_dist_r(vec2d_t *v1, vec2d_t *v2);
+/* Name of the instruction set used by the batch functions on this CPU */
+const char *vec_batch_isa(void);
 
 #endif // DIFFGAMES_3DTOOLS_H
@@ -0,0 +1,149 @@
+#ifndef DIFFGAMES_ASSIGN_H
+#define DIFFGAMES_ASSIGN_H
+
+/* Included files */
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "real.h"
+
+/* Assignment problem solver
+ *
+ * Finds the assignment of n rows to n columns, one column per row, with the
+ * smallest (or largest) total cost, in O(n^3) time with the Hungarian method.
+ * Every column is first matched to its cheapest row if that row is still free,
+ * then the rows left over are matched one at a time by the shortest augmenting
+ * path over the costs reduced by the row and column potentials. All the memory
+ * is allocated once by `assign_init`, so solving doesn't allocate.
+ *
+ * When the costs change little from one problem to the next, `assign_update`
+ * starts from the previous solution instead: the column potentials are kept,
+ * the rows whose column is still the cheapest after the change keep it, and
+ * only the others are matched again. Each of them costs O(n) for a short
+ * augmenting path, and O(n^2) at worst, on top of the O(n^2) to read the costs.
+ *
+ * The arrays other than `row_col` are indexed from 1, with the extra column 0
+ * standing for the row being added.
+ */
+
+typedef struct assign {
+  size_t n;        /* Number of rows and columns */
+  size_t *row_col; /* Column assigned to each row, the solution */
+  size_t *last;    /* Column assigned to each row by the previous solution */
+  size_t *col_row; /* Row assigned to each column, 0 if none */
+  size_t *way;     /* Previous column on the augmenting path */
+  double *u;       /* Potentials of the rows */
+  double *v;       /* Potentials of the columns */
+  double *minv;    /* Smallest reduced cost reaching each column */
+  bool *used;      /* Columns reached by the augmenting path */
+  bool solved;     /* Whether the above hold a solution to start from */
+} assign_t;
+
+/* assign_init
+ *
+ * Allocates a solver for assignment problems of a given size.
+ *
+ * Parameters:
+ * - a: The solver to initialize
+ * - n: The number of rows and columns
+ *
+ * Returns: False if the solver could not be allocated, true otherwise.
+ */
+bool assign_init(assign_t *a, size_t n);
+
+/* assign_free
+ *
+ * Frees the memory of a solver.
+ *
+ * Parameters:
+ * - a: The solver to free
+ */
+void assign_free(assign_t *a);
+
+/* assign_solve
+ *
+ * Solves an assignment problem. The solution is left in `a->row_col`; when
+ * several assignments are optimal, any one of them may be returned.
+ *
+ * Parameters:
+ * - a: The solver
+ * - cost: The n * n costs, row by row: cost[i * n + j] is the cost of
+ *         assigning column j to row i. They must be finite.
+ * - maximize: Whether to find the largest total cost instead of the smallest
+ *
+ * Returns: The total cost of the assignment.
+ */
+double assign_solve(assign_t *a, const real_t *cost, bool maximize);
+
+/* assign_update
+ *
+ * Solves an assignment problem starting from the solution of the previous one,
+ * which must have had the same `maximize`. Solves it from scratch if there is
+ * no previous solution. Like `assign_solve`, the solution is optimal, and left
+ * in `a->row_col`.
+ *
+ * Parameters:
+ * - a: The solver
+ * - cost: The n * n costs, row by row, see `assign_solve`
+ * - maximize: Whether to find the largest total cost instead of the smallest
+ *
+ * Returns: The number of rows assigned to a different column than before, so
+ *          0 if the assignment hasn't switched.
+ */
+size_t assign_update(assign_t *a, const real_t *cost, bool maximize);
+
+/* assign_search
+ *
+ * Solves an assignment problem by searching all n! assignments, in
+ * lexicographic order of the rows' columns, as a reference for the other
+ * solvers. Branches whose cost so far plus the smallest costs of the remaining
+ * rows can't beat the best assignment found are skipped, and the search only
+ * uses the solver's O(n) memory. Of several optimal assignments, the first in
+ * that order is returned in `a->row_col`. `assign_update` doesn't start from
+ * it.
+ *
+ * Parameters:
+ * - a: The solver
+ * - cost: The n * n costs, row by row, see `assign_solve`
+ * - maximize: Whether to find the largest total cost instead of the smallest
+ *
+ * Returns: The total cost of the assignment.
+ */
+double assign_search(assign_t *a, const real_t *cost, bool maximize);
+
+/* assign_copy
+ *
+ * Copies the solution of a solver, which `assign_update` then starts from, to
+ * another solver of the same size.
+ *
+ * Parameters:
+ * - dst: The solver to copy to
+ * - src: The solver to copy from
+ */
+void assign_copy(assign_t *dst, const assign_t *src);
+
+/* assign_save
+ *
+ * Saves what `assign_copy` copies, the solution `assign_update` starts from,
+ * into a buffer.
+ *
+ * Parameters:
+ * - a: The solver to save
+ * - buf: Where to save it, or NULL to only get the size
+ *
+ * Returns: The number of bytes saved, the same for every solver of a size.
+ */
+size_t assign_save(const assign_t *a, void *buf);
+
+/* assign_restore
+ *
+ * Puts back what `assign_save` saved of a solver of the same size.
+ *
+ * Parameters:
+ * - a: The solver to restore
+ * - buf: The saved solver
+ */
+void assign_restore(assign_t *a, const void *buf);
+
+#endif // DIFFGAMES_ASSIGN_H
@@ -3,9 +3,15 @@
 
 /* Included files */
 
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
 #include <stdlib.h>
 
+#include "real.h"
+
 struct dynsys_t; /* Forward definition */
+struct recorder; /* Trajectory recorder, see recorder.h */
 
 /* Dynamics function f(x, t)
  *
@@ -46,6 +52,38 @@ typedef void (*control_f)(void *state, double dt);
  */
 typedef double (*run_cost_f)(const void *state, double dt);
 
+/* Time-aware control input function u(x, t)
+ *
+ * Like the control input function, but also given the simulated time and the
+ * context pointer of the system, so that controllers which depend on time (or
+ * on anything outside of the private state) don't need to keep hidden state of
+ * their own. Systems using these can be simulated side by side, on any number
+ * of threads.
+ *
+ * Parameters:
+ * - state: The private state (containing state variables) of the dynamic system
+ * - t: The simulated time of the state
+ * - dt: The amount of time passed since the last time-step
+ * - ctx: The context pointer of the dynamic system
+ */
+typedef void (*control_tf)(void *state, double t, double dt, void *ctx);
+
+/* Time-aware running cost function g(x, t)
+ *
+ * Like the running cost function, but also given the simulated time and the
+ * context pointer of the system.
+ *
+ * Parameters:
+ * - state: The private state (containing state variables) of the dynamic system
+ * - t: The simulated time of the state, at the start of the time-step
+ * - dt: The length of the time-step
+ * - ctx: The context pointer of the dynamic system
+ *
+ * Returns: The running cost incurred for the time-step of duration `dt`.
+ */
+typedef double (*run_cost_tf)(const void *state, double t, double dt,
+                              void *ctx);
+
 /* Terminal cost function q(x)
  *
  * This function is used to calculate the terminal cost at the end of the
@@ -58,15 +96,211 @@ typedef double (*run_cost_f)(const void *state, double dt);
  */
 typedef double (*term_cost_f)(const void *x);
 
+/* State derivative function F(x) = dx/dt
+ *
+ * As an alternative to the dynamics function, a system can describe its
+ * dynamics by the time derivative of its state variables, which lets the
+ * dynamic system integrate them with a higher-order method. The state variables
+ * which are integrated are an array of `n` scalars (`real_t`), usually at the
+ * start of the private state. The remaining fields (i.e. control variables and
+ * parameters) are left untouched by the integrator.
+ *
+ * This function must not modify the state, since it is evaluated at
+ * intermediate points of the time-step.
+ *
+ * Parameters:
+ * - state: The private state (containing state variables) of the dynamic system
+ * - dxdt: Where to store the time derivative of the `n` state variables
+ */
+typedef void (*deriv_f)(const void *state, real_t *dxdt);
+
+/* Event function e(x)
+ *
+ * A continuous function of the state which crosses zero when an event happens,
+ * i.e. the distance between a pursuer and an evader minus the capture radius.
+ * The event is terminal: the system stops at the first time its event function
+ * falls from a positive value to zero or below.
+ *
+ * Parameters:
+ * - state: The private state (containing state variables) of the dynamic system
+ *
+ * Returns: The value of the event function, positive until the event happens.
+ */
+typedef double (*event_f)(const void *state);
+
+/* Event rate function
+ *
+ * Bounds how fast the event function can change, i.e. the closing speed of a
+ * pursuer and an evader for their distance. It lets a step rule out the event
+ * function dipping to zero and back between its ends, or else find the dip,
+ * which the values at the ends of the step alone can't tell.
+ *
+ * Parameters:
+ * - state: The private state (containing state variables) of the dynamic system
+ *
+ * Returns: A bound of |de/dt| over the next step, 0 if there is none.
+ */
+typedef double (*event_rate_f)(const void *state);
+
+/* State copy function
+ *
+ * Copies the private state of a system into another instance of the same
+ * system, which has been initialized with the same parameters. Only needed by
+ * systems whose private state points to memory of its own (i.e. arrays sized by
+ * a parameter), which must be copied into the destination's memory instead of
+ * sharing the source's.
+ *
+ * Parameters:
+ * - dst: The private state to copy into
+ * - src: The private state to copy
+ */
+typedef void (*state_copy_f)(void *dst, const void *src);
+
+/* State save function
+ *
+ * Saves the memory of its own which the private state of a system points to,
+ * other than the state variables, into a snapshot. Only needed by systems which
+ * keep more than their state variables there, i.e. a solution carried over
+ * from one step to the next.
+ *
+ * Parameters:
+ * - state: The private state to save
+ * - buf: Where to save it, aligned for any type, or NULL to only get the size
+ *
+ * Returns: The number of bytes saved, the same for every state of a system.
+ */
+typedef size_t (*state_save_f)(const void *state, void *buf);
+
+/* State restore function
+ *
+ * Puts back what a state save function saved of a private state.
+ *
+ * Parameters:
+ * - state: The private state the memory was saved from
+ * - buf: The saved memory
+ */
+typedef void (*state_restore_f)(void *state, const void *buf);
+
+/* Step function
+ *
+ * Steps a dynamic system as `dynsys_step` does, usually one specialized for a
+ * particular system with `DYNSYS_DEFINE_STEPPER` (see dynsys_stepper.h).
+ *
+ * Parameters:
+ * - s: The dynamic system to step forward in time
+ * - dt: How far forward in time to advance the system
+ *
+ * Returns: How far the system was advanced, less than `dt` if it stopped.
+ */
+typedef double (*dynsys_step_f)(struct dynsys_t *s, double dt);
+
+/* Integration methods for systems with a state derivative */
+
+enum integrator_e {
+  INTEGRATOR_EULER, /* Explicit Euler, 1st order */
+  INTEGRATOR_RK2,   /* Explicit midpoint, 2nd order */
+  INTEGRATOR_RK4,   /* Classic Runge-Kutta, 4th order */
+  INTEGRATOR_RK45,  /* Adaptive Dormand-Prince, 5th order */
+};
+
+/* Number of scalars of scratch space needed to integrate `n` state variables */
+
+#define DYNSYS_WORK_SIZE(n) (9 * (n))
+
+/* Error control of the adaptive integration method
+ *
+ * A step is accepted when the RMS of its estimated local error, with each
+ * state variable's error scaled by `atol + rtol * |x|`, is at most 1.
+ */
+
+typedef struct {
+  double rtol;  /* Relative error tolerance */
+  double atol;  /* Absolute error tolerance */
+  double h_min; /* Smallest step size, steps this small are always accepted */
+  double h_max; /* Largest step size */
+} dynsys_tol_t;
+
+#define DYNSYS_RTOL (1e-6)
+#define DYNSYS_ATOL (1e-6)
+#define DYNSYS_H_MIN (1e-9)
+#define DYNSYS_H_MAX (1.0)
+
+/* Default precision in seconds to which the time of an event is located */
+
+#define DYNSYS_EVENT_TOL (1e-9)
+
+/* Statistics of the integrator */
+
+typedef struct {
+  unsigned long accepted; /* Number of accepted (adaptive) steps */
+  unsigned long rejected; /* Number of steps rejected by error control */
+  unsigned long evals;    /* Number of state derivative evaluations */
+} dynsys_stats_t;
+
+/* Instrumentation
+ *
+ * Building with `CONFIG_PROFILE` set (`make PROFILE=1`) counts the calls to
+ * each function of a dynamic system and the time spent in them, per system.
+ * Time is measured in TSC cycles on x86 and in nanoseconds elsewhere. Otherwise
+ * the instrumentation is compiled out, and stepping is exactly as before.
+ */
+
+#ifndef CONFIG_PROFILE
+#define CONFIG_PROFILE (0)
+#endif
+
+enum dynsys_fn_e {
+  DYNSYS_FN_F,     /* Dynamics function */
+  DYNSYS_FN_D,     /* State derivative */
+  DYNSYS_FN_U,     /* Control input function */
+  DYNSYS_FN_G,     /* Running cost function */
+  DYNSYS_FN_Q,     /* Terminal cost function */
+  DYNSYS_FN_E,     /* Event function */
+  DYNSYS_FN_COUNT, /* Number of instrumented functions */
+};
+
+typedef struct {
+  unsigned long calls[DYNSYS_FN_COUNT]; /* Calls to each function */
+  uint64_t ticks[DYNSYS_FN_COUNT];      /* Time spent in each function */
+} dynsys_prof_t;
+
 /* Representation of a generic dynamic system */
 
 typedef struct dynsys_t {
-  void *x;       /* State vars */
-  double c;      /* Game cost tally */
-  dynamics_f f;  /* Dynamics function f(x, t) */
-  control_f u;   /* Control function u(t) */
-  run_cost_f g;  /* Running cost function l(x, t) */
-  term_cost_f q; /* Terminal cost function q(x) */
+  void *x;                  /* State vars */
+  double c;                 /* Game cost tally */
+  dynamics_f f;             /* Dynamics function f(x, t) */
+  control_f u;              /* Control function u(t) */
+  run_cost_f g;             /* Running cost function l(x, t) */
+  term_cost_f q;            /* Terminal cost function q(x) */
+  deriv_f d;                /* State derivative F(x), replaces f if not NULL */
+  real_t *v;                /* State variables integrated with d */
+  size_t n;                 /* Number of state variables integrated with d */
+  enum integrator_e method; /* Integration method used with d */
+  real_t *work;             /* Integrator scratch space */
+  dynsys_tol_t tol;         /* Error control of the adaptive method */
+  dynsys_stats_t stats;     /* Integrator statistics */
+  double h;                 /* Next step size of the adaptive method */
+  event_f e;                /* Terminal event function, may be NULL */
+  event_rate_f er;          /* Bound of the event function's rate, or NULL */
+  double e_tol;             /* Precision of the event time */
+  bool event;               /* True once the terminal event happened */
+  struct recorder *rec;     /* Records the state after every step, or NULL */
+  size_t size;              /* Size of the private state, 0 if unknown */
+  state_copy_f copy;        /* Copies the private state, NULL for memcpy */
+  state_save_f save;        /* Saves what the private state points to */
+  state_restore_f restore;  /* Restores what the private state points to */
+  control_tf ut;            /* Time-aware control function, replaces u */
+  run_cost_tf gt;           /* Time-aware running cost function, replaces g */
+  double t;                 /* Simulated time */
+  void *ctx;                /* Context pointer for time-aware functions */
+  double u_period;          /* Control period, 0 to control every step */
+  double u_next;            /* Simulated time the control is next due */
+  double u_last;            /* Simulated time of the last control update */
+  dynsys_step_f step;       /* Specialized step function, NULL for generic */
+#if CONFIG_PROFILE
+  dynsys_prof_t prof;       /* Calls to and time spent in the functions */
+#endif
 } dynsys_t;
 
 #define DYNSYS_SINIT(d_x, d_f, d_u, d_g, d_q)                                  \
@@ -77,6 +311,31 @@ typedef struct dynsys_t {
       .u = (d_u),                                                              \
       .g = (d_g),                                                              \
       .q = (d_q),                                                              \
+      .d = NULL,                                                               \
+      .v = NULL,                                                               \
+      .n = 0,                                                                  \
+      .method = INTEGRATOR_EULER,                                              \
+      .work = NULL,                                                            \
+      .tol = {DYNSYS_RTOL, DYNSYS_ATOL, DYNSYS_H_MIN, DYNSYS_H_MAX},           \
+      .stats = {0, 0, 0},                                                      \
+      .h = 0.0,                                                                \
+      .e = NULL,                                                               \
+      .er = NULL,                                                              \
+      .e_tol = DYNSYS_EVENT_TOL,                                               \
+      .event = false,                                                          \
+      .rec = NULL,                                                             \
+      .size = 0,                                                               \
+      .copy = NULL,                                                            \
+      .save = NULL,                                                            \
+      .restore = NULL,                                                         \
+      .ut = NULL,                                                              \
+      .gt = NULL,                                                              \
+      .t = 0.0,                                                                \
+      .ctx = NULL,                                                             \
+      .u_period = 0.0,                                                         \
+      .u_next = 0.0,                                                           \
+      .u_last = 0.0,                                                           \
+      .step = NULL,                                                            \
   }
 
 /* dynsys_step
@@ -96,18 +355,202 @@ typedef struct dynsys_t {
 void dynsys_init(dynsys_t *s, void *x, dynamics_f f, control_f u, run_cost_f g,
                  term_cost_f q);
 
+/* dynsys_init_ode
+ *
+ * Initialize a dynamic system whose dynamics are given by the time derivative
+ * of its state variables. Scratch space for the integrator is allocated, and
+ * must be released with `dynsys_free`.
+ *
+ * Parameters:
+ * - s: The dynamic system to initialize
+ * - x: The private system state
+ * - v: The state variables to integrate, usually the start of `x`
+ * - n: The number of state variables (scalars) to integrate
+ * - d: The state derivative of the system
+ * - method: The integration method
+ * - u: The control input equation for the system. If NULL, the system runs
+ *      from its initial conditions with no control.
+ * - g: The running cost equation. If NULL, the running cost is assumed to be 0
+ * - q: The terminal cost equation. If NULL, the terminal cost is assumed to be
+ *      0
+ *
+ * Returns: False if the scratch space could not be allocated, true otherwise.
+ */
+bool dynsys_init_ode(dynsys_t *s, void *x, real_t *v, size_t n, deriv_f d,
+                     enum integrator_e method, control_f u, run_cost_f g,
+                     term_cost_f q);
+
+/* dynsys_set_integrator
+ *
+ * Changes the integration method of a system initialized with
+ * `dynsys_init_ode`.
+ *
+ * Parameters:
+ * - s: The dynamic system
+ * - method: The integration method
+ */
+void dynsys_set_integrator(dynsys_t *s, enum integrator_e method);
+
+/* dynsys_set_tolerance
+ *
+ * Sets the error control of the adaptive integration method. Systems start out
+ * with `DYNSYS_RTOL`, `DYNSYS_ATOL`, `DYNSYS_H_MIN` and `DYNSYS_H_MAX`.
+ *
+ * Parameters:
+ * - s: The dynamic system
+ * - tol: The tolerances and step size bounds
+ */
+void dynsys_set_tolerance(dynsys_t *s, const dynsys_tol_t *tol);
+
+/* dynsys_set_event
+ *
+ * Sets the terminal event of a system. Systems with a state derivative stop
+ * exactly at the event, up to `tol`: the step in which the event function
+ * changes sign is repeated with shorter lengths, found by the Illinois variant
+ * of regula falsi. Systems with a dynamics function can only stop at the end of
+ * the step in which the event happened.
+ *
+ * Parameters:
+ * - s: The dynamic system
+ * - e: The event function, NULL to remove the event
+ * - tol: The precision in seconds to which the time of the event is located
+ */
+void dynsys_set_event(dynsys_t *s, event_f e, double tol);
+
+/* dynsys_set_event_rate
+ *
+ * Sets the bound of the rate of a system's event function. Without it, a step
+ * whose ends both have a positive event function only samples it in between,
+ * so the event may be missed by large steps. With it, the first time within
+ * the step at which the event function reaches zero is always found.
+ *
+ * Parameters:
+ * - s: The dynamic system
+ * - rate: The event rate function, NULL if there is no bound
+ */
+void dynsys_set_event_rate(dynsys_t *s, event_rate_f rate);
+
+/* dynsys_set_recorder
+ *
+ * Records the state variables of a system with a state derivative after every
+ * step, starting with the current state at time 0.
+ *
+ * Parameters:
+ * - s: The dynamic system
+ * - rec: The recorder, NULL to stop recording
+ */
+void dynsys_set_recorder(dynsys_t *s, struct recorder *rec);
+
+/* dynsys_set_control
+ *
+ * Replaces the control input and running cost functions of a system with
+ * time-aware ones.
+ *
+ * Parameters:
+ * - s: The dynamic system
+ * - u: The time-aware control input function. If NULL, there is no control.
+ * - g: The time-aware running cost function. If NULL, it is assumed to be 0
+ * - ctx: The context pointer passed to `u` and `g`, may be NULL
+ */
+void dynsys_set_control(dynsys_t *s, control_tf u, run_cost_tf g, void *ctx);
+
+/* dynsys_set_control_period
+ *
+ * Applies the control input at a lower rate than the dynamics are integrated.
+ * The control is applied after the next step, then after the step closest to
+ * every `period` seconds of simulated time from then on, and the control
+ * variables are held in between (zero-order hold). The control function is
+ * given the time since its last update as its time-step. Expensive controllers
+ * can thus run at i.e. 10 Hz while the dynamics are integrated at 100 Hz.
+ *
+ * Parameters:
+ * - s: The dynamic system
+ * - period: The control period in seconds, 0 to apply the control after every
+ *           step
+ */
+void dynsys_set_control_period(dynsys_t *s, double period);
+
+/* dynsys_set_stepper
+ *
+ * Replaces the step of a system with a state derivative by one specialized for
+ * it, i.e. defined with `DYNSYS_DEFINE_STEPPER`, whose calls to the system's
+ * functions can be inlined. The specialized step computes the same steps as
+ * the generic one.
+ *
+ * Parameters:
+ * - s: The dynamic system
+ * - step: The step function, NULL to use the generic step
+ */
+void dynsys_set_stepper(dynsys_t *s, dynsys_step_f step);
+
+/* dynsys_set_state
+ *
+ * Tells the system the size of its private state, so that it can be saved,
+ * restored and forked.
+ *
+ * Parameters:
+ * - s: The dynamic system
+ * - size: The size of the private state in bytes
+ * - copy: Copies the private state between instances. If NULL, the private
+ *         state is copied byte for byte, along with the state variables if
+ *         they live outside of it.
+ * - save: Saves the memory the private state points to into snapshots, on top
+ *         of the private state and the state variables. May be NULL.
+ * - restore: Restores what `save` saved, NULL if `save` is
+ */
+void dynsys_set_state(dynsys_t *s, size_t size, state_copy_f copy,
+                      state_save_f save, state_restore_f restore);
+
+/* dynsys_free
+ *
+ * Releases the resources held by a dynamic system (not its private state).
+ *
+ * Parameters:
+ * - s: The dynamic system
+ */
+void dynsys_free(dynsys_t *s);
+
 /* dynsys_step
  *
  * Steps the system dynamics forward in time by:
  * 1) Tallying the running cost
- * 2) Applying the system dynamics function
- * 3) Applying the control input function
+ * 2) Applying the system dynamics function, or integrating the state
+ *    derivative with the system's integration method
+ * 3) Advancing the simulated time and applying the control input function,
+ *    if it is due (see `dynsys_set_control_period`)
+ *
+ * With `INTEGRATOR_RK45`, the state is integrated across `dt` with as many
+ * error controlled steps as needed, while the control variables are held.
+ *
+ * If the terminal event happens during the step, the system stops at the event
+ * and any further steps do nothing.
+ *
+ * The step is taken by the system's specialized step function if it has one
+ * (see `dynsys_set_stepper`).
  *
  * Parameters:
  * - s: The dynamic system to step forward in time
  * - dt: How far forward in time to advance the system
+ *
+ * Returns: How far the system was advanced, less than `dt` if it stopped.
+ */
+double dynsys_step(dynsys_t *s, double dt);
+
+/* dynsys_step_adaptive
+ *
+ * Steps a system integrated with `INTEGRATOR_RK45` forward in time by a single
+ * step, whose size is picked by the error control. The running cost and the
+ * control input are updated as in `dynsys_step`, so the control variables are
+ * held constant over the step. With a control period, the step ends at the next
+ * control update at the latest. The step is cut short by the terminal event.
+ *
+ * Parameters:
+ * - s: The dynamic system to advance
+ * - dt_max: The largest step to take, i.e. the time left until some deadline
+ *
+ * Returns: The size of the step which was taken.
  */
-void dynsys_step(dynsys_t *s, double dt);
+double dynsys_step_adaptive(dynsys_t *s, double dt_max);
 
 /* dynsys_cost
  *
@@ -121,4 +564,239 @@ void dynsys_step(dynsys_t *s, double dt);
  */
 double dynsys_cost(const dynsys_t *s);
 
+/* Batched dynamic systems
+ *
+ * A batch holds K instances of the same dynamic system. Unlike `dynsys_t`, the
+ * state of all instances is owned by a single private state which is expected
+ * to store its variables as a structure of arrays (one array of K values per
+ * state variable). The batched functions below receive the whole batch, so
+ * that their loops over the instances can be vectorized.
+ */
+
+/* Batched dynamics function f(X, t)
+ *
+ * Parameters:
+ * - state: The private state of all instances
+ * - k: The number of instances
+ * - dt: The amount of time passed since the last time-step
+ */
+typedef void (*batch_dynamics_f)(void *state, size_t k, double dt);
+
+/* Batched control input function u(t)
+ *
+ * Parameters:
+ * - state: The private state of all instances
+ * - k: The number of instances
+ * - dt: The amount of time passed since the last time-step
+ */
+typedef void (*batch_control_f)(void *state, size_t k, double dt);
+
+/* Batched running cost function g(X, t)
+ *
+ * Parameters:
+ * - state: The private state of all instances
+ * - k: The number of instances
+ * - dt: The amount of time passed since the last time-step
+ * - cost: The cost tally of each instance, to which the running cost incurred
+ *         for the time-step of duration `dt` is added
+ */
+typedef void (*batch_run_cost_f)(const void *state, size_t k, double dt,
+                                 double *cost);
+
+/* Batched terminal cost function q(X)
+ *
+ * Parameters:
+ * - state: The private state of all instances
+ * - k: The number of instances
+ * - cost: The cost of each instance, to which the terminal cost is added
+ */
+typedef void (*batch_term_cost_f)(const void *state, size_t k, double *cost);
+
+/* Representation of a batch of generic dynamic systems */
+
+typedef struct dynsys_batch_t {
+  void *x;             /* State vars of all instances */
+  size_t k;            /* Number of instances */
+  double *c;           /* Game cost tally of each instance */
+  batch_dynamics_f f;  /* Dynamics function f(X, t) */
+  batch_control_f u;   /* Control function u(t) */
+  batch_run_cost_f g;  /* Running cost function l(X, t) */
+  batch_term_cost_f q; /* Terminal cost function q(X) */
+} dynsys_batch_t;
+
+/* dynsys_batch_init
+ *
+ * Initialize a batch of dynamic systems.
+ *
+ * Parameters:
+ * - s: The batch to initialize
+ * - x: The private state of all instances
+ * - k: The number of instances
+ * - c: Storage for the cost tally of each instance, `k` entries
+ * - f: The batched dynamics equations of the system
+ * - u: The batched control input equation. If NULL, there is no control.
+ * - g: The batched running cost equation. If NULL, it is assumed to be 0
+ * - q: The batched terminal cost equation. If NULL, it is assumed to be 0
+ */
+void dynsys_batch_init(dynsys_batch_t *s, void *x, size_t k, double *c,
+                       batch_dynamics_f f, batch_control_f u,
+                       batch_run_cost_f g, batch_term_cost_f q);
+
+/* dynsys_batch_step
+ *
+ * Steps every instance of the batch forward in time, in the same order as
+ * `dynsys_step`.
+ *
+ * Parameters:
+ * - s: The batch to step forward in time
+ * - dt: How far forward in time to advance the batch
+ */
+void dynsys_batch_step(dynsys_batch_t *s, double dt);
+
+/* dynsys_batch_cost
+ *
+ * Calculates the total cost of every instance, as `dynsys_cost` does.
+ *
+ * Parameters:
+ * - s: The batch to get the costs of
+ * - cost: Where to store the `k` total costs
+ */
+void dynsys_batch_cost(const dynsys_batch_t *s, double *cost);
+
+/* dynsys_prof_reset
+ *
+ * Clears the instrumentation counters of a system. Does nothing unless built
+ * with `CONFIG_PROFILE`.
+ *
+ * Parameters:
+ * - s: The dynamic system
+ */
+void dynsys_prof_reset(dynsys_t *s);
+
+/* dynsys_prof_dump
+ *
+ * Prints the number of calls to each of the system's functions, the mean time
+ * per call and each function's share of the total. Prints nothing unless built
+ * with `CONFIG_PROFILE`.
+ *
+ * Parameters:
+ * - s: The dynamic system
+ * - out: Where to print the summary
+ */
+void dynsys_prof_dump(const dynsys_t *s, FILE *out);
+
+/* Snapshots
+ *
+ * A snapshot holds everything which changes as a system is stepped: the private
+ * state, the state variables, whatever else the system's save function saves,
+ * the simulated time, the cost tally and the integrator's step size,
+ * statistics and event flag. Restoring a snapshot puts
+ * the system back exactly where it was, so stepping it again gives the same
+ * results. Snapshots can only be restored into the system they were taken of,
+ * since the private state may point to memory of its own; use `dynsys_fork` to
+ * copy a running system into another instance.
+ */
+
+/* dynsys_snapshot_size
+ *
+ * Parameters:
+ * - s: The dynamic system, with its state size set
+ *
+ * Returns: The size of a snapshot of the system in bytes.
+ */
+size_t dynsys_snapshot_size(const dynsys_t *s);
+
+/* dynsys_save
+ *
+ * Takes a snapshot of a system.
+ *
+ * Parameters:
+ * - s: The dynamic system
+ * - buf: Where to store the snapshot, `dynsys_snapshot_size` bytes aligned for
+ *        any type
+ */
+void dynsys_save(const dynsys_t *s, void *buf);
+
+/* dynsys_restore
+ *
+ * Puts a system back into the state of a snapshot taken of it.
+ *
+ * Parameters:
+ * - s: The dynamic system
+ * - buf: The snapshot
+ */
+void dynsys_restore(dynsys_t *s, const void *buf);
+
+/* dynsys_fork
+ *
+ * Copies a running system into another instance of the same system, which
+ * then continues from the same point. The destination keeps its own private
+ * state and scratch memory, so both can be stepped independently (and on
+ * different threads).
+ *
+ * Parameters:
+ * - dst: The system to fork into, initialized with the same parameters
+ * - src: The system to fork
+ */
+void dynsys_fork(dynsys_t *dst, const dynsys_t *src);
+
+/* Checkpoint arena
+ *
+ * A stack of snapshots of a single system in one allocation, so that taking a
+ * checkpoint is a copy of the state without any allocation.
+ */
+
+typedef struct {
+  unsigned char *buf; /* Checkpoints, one after the other */
+  size_t slot;        /* Size of a checkpoint in bytes */
+  size_t cap;         /* Number of checkpoints which fit */
+  size_t n;           /* Number of checkpoints held */
+} dynsys_arena_t;
+
+/* dynsys_arena_init
+ *
+ * Allocates space for the checkpoints of a system.
+ *
+ * Parameters:
+ * - a: The arena to initialize
+ * - s: The dynamic system, with its state size set
+ * - cap: The number of checkpoints to make space for
+ *
+ * Returns: False if the arena could not be allocated, true otherwise.
+ */
+bool dynsys_arena_init(dynsys_arena_t *a, const dynsys_t *s, size_t cap);
+
+/* dynsys_arena_free
+ *
+ * Releases the checkpoints of an arena.
+ *
+ * Parameters:
+ * - a: The arena
+ */
+void dynsys_arena_free(dynsys_arena_t *a);
+
+/* dynsys_checkpoint
+ *
+ * Pushes a snapshot of a system onto an arena.
+ *
+ * Parameters:
+ * - a: The arena
+ * - s: The dynamic system the arena was initialized for
+ *
+ * Returns: False if the arena is full, true otherwise.
+ */
+bool dynsys_checkpoint(dynsys_arena_t *a, const dynsys_t *s);
+
+/* dynsys_rollback
+ *
+ * Restores a system to one of its checkpoints, dropping every checkpoint taken
+ * after it. The checkpoint itself is kept, so it can be rolled back to again.
+ *
+ * Parameters:
+ * - a: The arena
+ * - s: The dynamic system the arena was initialized for
+ * - i: The checkpoint to roll back to, counting from 0
+ */
+void dynsys_rollback(dynsys_arena_t *a, dynsys_t *s, size_t i);
+
 #endif // DIFFGAMES_DYNSYS_H
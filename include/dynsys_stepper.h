@@ -0,0 +1,430 @@
+#ifndef DIFFGAMES_DYNSYS_STEPPER_H
+#define DIFFGAMES_DYNSYS_STEPPER_H
+
+/* Included files */
+
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+
+#if CONFIG_PROFILE
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#else
+#include <time.h>
+#endif
+#endif
+
+#include "dynsys.h"
+#include "recorder.h"
+
+/* Specialized steppers
+ *
+ * `dynsys_step` calls the functions of a system through the pointers in
+ * `dynsys_t`, so none of them can be inlined. The step itself is written once,
+ * below, as inline functions which take the system's functions as arguments.
+ * `dynsys_step` instantiates them with the pointers of the system, while
+ * `DYNSYS_DEFINE_STEPPER` instantiates them with a game's own functions, which
+ * the compiler then inlines (and vectorizes) into a step specialized for that
+ * game. Both compute exactly the same steps.
+ *
+ * A specialized stepper is used by setting it on the system with
+ * `dynsys_set_stepper`. It only handles the system it was defined for: if any
+ * of the system's functions are changed, it falls back to the generic step.
+ */
+
+#if defined(__GNUC__)
+#define DYNSYS_INLINE static inline __attribute__((always_inline))
+#else
+#define DYNSYS_INLINE static inline
+#endif
+
+/* Instrumentation, compiled out entirely unless `CONFIG_PROFILE` is set */
+
+#if CONFIG_PROFILE
+
+#if defined(__x86_64__) || defined(__i386__)
+#define DYNSYS_PROF_UNIT "cycles"
+static inline uint64_t dynsys_prof_ticks(void) { return __rdtsc(); }
+#else
+#define DYNSYS_PROF_UNIT "ns"
+static inline uint64_t dynsys_prof_ticks(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+#endif
+
+#define DYNSYS_PROF(s, fn, call)                                               \
+  do {                                                                         \
+    uint64_t prof_start = dynsys_prof_ticks();                                 \
+    call;                                                                      \
+    (s)->prof.ticks[(fn)] += dynsys_prof_ticks() - prof_start;                 \
+    (s)->prof.calls[(fn)]++;                                                   \
+  } while (0)
+
+#else
+#define DYNSYS_PROF(s, fn, call) call
+#endif
+
+/* The scratch space holds the state variables at the start of the step, one
+ * derivative per stage of the adaptive method, then a copy of the state
+ * variables.
+ */
+
+#define DYNSYS_DOPRI_STAGES (7)
+#define DYNSYS_EVENT_ITER_MAX (100) /* Most refinements of an event time */
+
+/* dynsys_step_generic
+ *
+ * Steps a system as `dynsys_step` does, through the function pointers of the
+ * system, ignoring its specialized step function.
+ *
+ * Parameters:
+ * - s: The dynamic system to step forward in time
+ * - dt: How far forward in time to advance the system
+ *
+ * Returns: How far the system was advanced, less than `dt` if it stopped.
+ */
+double dynsys_step_generic(dynsys_t *s, double dt);
+
+/* The adaptive method is left out of line, since its error control dwarfs the
+ * cost of calling the state derivative through its pointer.
+ */
+
+double dynsys_dopri_attempt(dynsys_t *s, double h);
+double dynsys_dopri_step(dynsys_t *s, double dt_max);
+
+/* Evaluates the state derivative at the current state */
+DYNSYS_INLINE void dynsys_deriv(dynsys_t *s, deriv_f d, real_t *dxdt) {
+  DYNSYS_PROF(s, DYNSYS_FN_D, d(s->x, dxdt));
+}
+
+/* Evaluates the event function at the current state */
+DYNSYS_INLINE double dynsys_event_value(dynsys_t *s, event_f e) {
+  double v;
+  DYNSYS_PROF(s, DYNSYS_FN_E, v = e(s->x));
+  return v;
+}
+
+/* Stores x0 + h * k in x */
+DYNSYS_INLINE void dynsys_ode_stage(real_t *x, const real_t *x0, real_t h,
+                                    const real_t *k, size_t n) {
+  for (size_t i = 0; i < n; i++) {
+    x[i] = x0[i] + h * k[i];
+  }
+}
+
+/* Saves the state variables and their derivative at the start of a step, which
+ * every step (and retry of a step) starts from.
+ */
+DYNSYS_INLINE void dynsys_ode_save(dynsys_t *s, deriv_f d) {
+  memcpy(s->work, s->v, sizeof(real_t) * s->n);
+  dynsys_deriv(s, d, s->work + s->n);
+  s->stats.evals++;
+}
+
+/* Integrates the state variables from the saved state over a single step of
+ * size h. Intermediate stages are written straight into the state variables so
+ * that the derivative sees the control variables and parameters next to them.
+ */
+DYNSYS_INLINE void dynsys_ode_single(dynsys_t *s, double h,
+                                     enum integrator_e method, deriv_f d) {
+  real_t *x = s->v;
+  size_t n = s->n;
+  real_t *x0 = s->work;
+  real_t *k1 = x0 + n;
+  real_t *k2 = k1 + n;
+  real_t *k3 = k2 + n;
+  real_t *k4 = k3 + n;
+  real_t h6 = h / 6;
+
+  switch (method) {
+  case INTEGRATOR_EULER:
+    dynsys_ode_stage(x, x0, h, k1, n);
+    break;
+
+  case INTEGRATOR_RK2:
+    dynsys_ode_stage(x, x0, h / 2, k1, n);
+    dynsys_deriv(s, d, k2);
+    dynsys_ode_stage(x, x0, h, k2, n);
+    s->stats.evals += 1;
+    break;
+
+  case INTEGRATOR_RK4:
+    dynsys_ode_stage(x, x0, h / 2, k1, n);
+    dynsys_deriv(s, d, k2);
+    dynsys_ode_stage(x, x0, h / 2, k2, n);
+    dynsys_deriv(s, d, k3);
+    dynsys_ode_stage(x, x0, h, k3, n);
+    dynsys_deriv(s, d, k4);
+    for (size_t i = 0; i < n; i++) {
+      x[i] = x0[i] + h6 * (k1[i] + 2 * k2[i] + 2 * k3[i] + k4[i]);
+    }
+    s->stats.evals += 3;
+    break;
+
+  case INTEGRATOR_RK45:
+    dynsys_dopri_attempt(s, h);
+    break;
+  }
+}
+
+/* Looks for the event function dipping to zero and back within a step of size
+ * h, i.e. a pursuer passing through the capture radius between the ends of the
+ * step, from time a on, whose event function value is ea. The value at the end
+ * of the step is e1.
+ *
+ * With a bound L on the rate of the event function, it can't fall below
+ * (ea + eb - L * (b - a)) / 2 between two times a and b. Intervals whose bound
+ * is positive are ruled out one after the other from the start of the step,
+ * and the others are split where their bound is lowest, until the event
+ * function is found at zero or below, or the whole step is ruled out. Without a
+ * bound, the event function is sampled at the midpoint of the step, and at the
+ * vertex of the parabola through the three samples if the midpoint is lowest.
+ * If no dip is found, the state is restored to the end of the step.
+ *
+ * Returns: True if the event function is positive at time `a` and at most zero
+ * at time `b` within the step, where the state is left.
+ */
+DYNSYS_INLINE bool dynsys_ode_event_dip(dynsys_t *s, double e1, double h,
+                                        double *a, double *ea, double *b,
+                                        double *eb, enum integrator_e method,
+                                        deriv_f d, event_f e) {
+  double rate = s->er != NULL ? s->er(s->x) : 0.0;
+  if (rate > 0.0 && *ea + e1 > rate * h) return false; /* Can't dip */
+
+  real_t *x1 = s->work + (DYNSYS_DOPRI_STAGES + 1) * s->n;
+  memcpy(x1, s->v, sizeof(real_t) * s->n);
+
+  if (rate > 0.0) {
+    double tb[DYNSYS_EVENT_ITER_MAX + 1]; /* Ends of the intervals left */
+    double vb[DYNSYS_EVENT_ITER_MAX + 1]; /* Event function at those ends */
+    size_t top = 1;
+    tb[0] = h;
+    vb[0] = e1;
+
+    for (unsigned i = 0; i < DYNSYS_EVENT_ITER_MAX && top > 0;) {
+      double t = tb[top - 1];
+      double v = vb[top - 1];
+      if (*ea + v > rate * (t - *a) || t - *a <= s->e_tol) {
+        *a = t; /* Ruled out, or too short to tell */
+        *ea = v;
+        top--;
+        continue;
+      }
+
+      double c = (*a + t) / 2 + (*ea - v) / (2 * rate);
+      if (c <= *a || c >= t) c = (*a + t) / 2;
+      dynsys_ode_single(s, c, method, d);
+      tb[top] = c;
+      vb[top] = dynsys_event_value(s, e);
+      i++;
+      if (vb[top] <= 0.0) {
+        *b = c;
+        *eb = vb[top];
+        return true;
+      }
+      top++;
+    }
+  } else {
+    *b = h / 2;
+    dynsys_ode_single(s, *b, method, d);
+    *eb = dynsys_event_value(s, e);
+    if (*eb <= 0.0) return true;
+
+    if (*eb < fmin(*ea, e1)) {
+      double pa = 2 * (e1 - 2 * *eb + *ea);
+      double pb = 4 * *eb - 3 * *ea - e1;
+      *b = -pb / (2 * pa) * h;
+      dynsys_ode_single(s, *b, method, d);
+      *eb = dynsys_event_value(s, e);
+      if (*eb <= 0.0) return true;
+    }
+  }
+
+  memcpy(s->v, x1, sizeof(real_t) * s->n);
+  return false;
+}
+
+/* Checks whether the terminal event happened during the step of size h just
+ * taken from the saved state, whose event function value was e0. If it did,
+ * the step is repeated up to the time of the event, bracketed with the Illinois
+ * method. The state is left just past the event, so that the event function is
+ * at most zero.
+ *
+ * Returns: The length of the step after locating the event.
+ */
+DYNSYS_INLINE double dynsys_ode_event(dynsys_t *s, double e0, double h,
+                                      enum integrator_e method, deriv_f d,
+                                      event_f e) {
+  double a = 0.0;
+  double b = h;
+  double ea = e0;
+  double eb = dynsys_event_value(s, e);
+  int side = 0;
+
+  if (eb > 0.0 &&
+      !dynsys_ode_event_dip(s, eb, h, &a, &ea, &b, &eb, method, d, e)) {
+    return h;
+  }
+  s->event = true;
+
+  for (unsigned i = 0; i < DYNSYS_EVENT_ITER_MAX && b - a > s->e_tol; i++) {
+    double c = (a * eb - b * ea) / (eb - ea);
+    if (c <= a || c >= b) c = (a + b) / 2; /* Keep strictly inside */
+    dynsys_ode_single(s, c, method, d);
+    double ec = dynsys_event_value(s, e);
+
+    /* Halving the function value at the end which is kept twice in a row
+     * prevents regula falsi from converging from one side only.
+     */
+
+    if (ec > 0.0) {
+      a = c;
+      ea = ec;
+      if (side == -1) eb /= 2;
+      side = -1;
+    } else {
+      b = c;
+      eb = ec;
+      if (side == 1) ea /= 2;
+      side = 1;
+    }
+  }
+
+  if (side == -1) dynsys_ode_single(s, b, method, d); /* Last was before b */
+  return b;
+}
+
+/* Takes a single step of the system's integration method of at most dt_max,
+ * stopping at the terminal event. Returns the size of the step.
+ */
+DYNSYS_INLINE double dynsys_ode_step(dynsys_t *s, double dt_max,
+                                     enum integrator_e method, deriv_f d,
+                                     event_f e) {
+  double e0 = e != NULL ? dynsys_event_value(s, e) : 1.0;
+  double h = dt_max;
+
+  if (e0 <= 0.0) {
+    s->event = true; /* Happened before the step, i.e. initial conditions */
+    return 0.0;
+  }
+
+  if (method == INTEGRATOR_RK45) {
+    h = dynsys_dopri_step(s, dt_max);
+  } else {
+    dynsys_ode_save(s, d);
+    dynsys_ode_single(s, h, method, d);
+    s->stats.accepted++;
+  }
+
+  if (e != NULL) h = dynsys_ode_event(s, e0, h, method, d, e);
+  return h;
+}
+
+/* Integrates the state variables across dt, in as many steps as the
+ * integration method needs. Returns how far the state was integrated.
+ */
+DYNSYS_INLINE double dynsys_ode_integrate(dynsys_t *s, double dt,
+                                          enum integrator_e method, deriv_f d,
+                                          event_f e) {
+  double t = 0.0;
+  while (t < dt && !s->event) {
+    double left = dt - t;
+    double h = dynsys_ode_step(s, left, method, d, e);
+    t = h == left ? dt : t + h;
+  }
+  return t;
+}
+
+/* True if the system has a running cost */
+DYNSYS_INLINE bool dynsys_has_run_cost(const dynsys_t *s, run_cost_tf g) {
+  return g != NULL || s->g != NULL;
+}
+
+/* Running cost over a step of size dt from the current state */
+DYNSYS_INLINE double dynsys_run_cost(dynsys_t *s, double dt, run_cost_tf g) {
+  double cost = 0.0;
+  if (g != NULL) {
+    DYNSYS_PROF(s, DYNSYS_FN_G, cost = g(s->x, s->t, dt, s->ctx));
+  } else if (s->g != NULL) {
+    DYNSYS_PROF(s, DYNSYS_FN_G, cost = s->g(s->x, dt));
+  }
+  return cost;
+}
+
+/* Applies the control input to the state after a step of size dt, if it is
+ * due. The update is due at the step ending closest to its time, so that it
+ * doesn't slip a step due to rounding in the simulated time.
+ */
+DYNSYS_INLINE void dynsys_control(dynsys_t *s, double dt, control_tf u) {
+  if (s->u_period > 0.0) {
+    if (s->t + 0.5 * dt < s->u_next) return; /* Held until due */
+    dt = s->t - s->u_last;
+    s->u_last = s->t;
+    s->u_next += s->u_period;
+    if (s->u_next <= s->t) s->u_next = s->t + s->u_period; /* Fell behind */
+  }
+
+  if (u != NULL) {
+    DYNSYS_PROF(s, DYNSYS_FN_U, u(s->x, s->t, dt, s->ctx));
+  } else if (s->u != NULL) {
+    DYNSYS_PROF(s, DYNSYS_FN_U, s->u(s->x, dt));
+  }
+}
+
+/* Steps a system with a state derivative, as `dynsys_step` */
+DYNSYS_INLINE double dynsys_step_ode(dynsys_t *s, double dt,
+                                     enum integrator_e method, deriv_f d,
+                                     control_tf u, run_cost_tf g, event_f e) {
+  double cost = 0.0;
+
+  if (s->event) return 0.0; /* Stopped by the terminal event */
+  if (dynsys_has_run_cost(s, g)) cost = dynsys_run_cost(s, dt, g);
+
+  double h = dynsys_ode_integrate(s, dt, method, d, e);
+
+  s->c += h < dt ? cost * (h / dt) : cost; /* Prorated if stopped early */
+  s->t += h;
+  if (!s->event) dynsys_control(s, h, u); /* Update control variables */
+  if (s->rec != NULL) recorder_append(s->rec, h, s->v);
+  return h;
+}
+
+/* DYNSYS_DEFINE_STEPPER
+ *
+ * Defines a step function specialized for a game with a state derivative, to
+ * be set with `dynsys_set_stepper`. The functions given are the ones the
+ * system is set up with (NULL for any it doesn't have), and must be visible
+ * where the stepper is defined for them to be inlined. Every integration
+ * method gets its own copy of the step, so the method can still be changed
+ * with `dynsys_set_integrator`.
+ *
+ * Parameters:
+ * - name: The name of the step function, which is static
+ * - m_d: The state derivative
+ * - m_u: The time-aware control input function
+ * - m_g: The time-aware running cost function
+ * - m_e: The terminal event function
+ */
+#define DYNSYS_DEFINE_STEPPER(name, m_d, m_u, m_g, m_e)                        \
+  static double name(dynsys_t *s, double dt) {                                 \
+    if (s->d != (m_d) || s->ut != (m_u) || s->gt != (m_g) || s->e != (m_e)) {  \
+      return dynsys_step_generic(s, dt);                                       \
+    }                                                                          \
+                                                                               \
+    switch (s->method) {                                                       \
+    case INTEGRATOR_EULER:                                                     \
+      return dynsys_step_ode(s, dt, INTEGRATOR_EULER, m_d, m_u, m_g, m_e);     \
+    case INTEGRATOR_RK2:                                                       \
+      return dynsys_step_ode(s, dt, INTEGRATOR_RK2, m_d, m_u, m_g, m_e);       \
+    case INTEGRATOR_RK4:                                                       \
+      return dynsys_step_ode(s, dt, INTEGRATOR_RK4, m_d, m_u, m_g, m_e);       \
+    case INTEGRATOR_RK45:                                                      \
+      return dynsys_step_ode(s, dt, INTEGRATOR_RK45, m_d, m_u, m_g, m_e);      \
+    }                                                                          \
+    return dynsys_step_generic(s, dt);                                         \
+  }
+
+#endif // DIFFGAMES_DYNSYS_STEPPER_H
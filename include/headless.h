@@ -0,0 +1,293 @@
+#ifndef DIFFGAMES_HEADLESS_H
+#define DIFFGAMES_HEADLESS_H
+
+/* Included files */
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "dynsys.h"
+#include "rng.h"
+
+/* Terminal condition function
+ *
+ * This function decides whether the game has ended (i.e. a capture occurred).
+ *
+ * Parameters:
+ * - state: The private state (containing state variables) of the dynamic system
+ *
+ * Returns: True if the game is over, false otherwise.
+ */
+typedef bool (*term_cond_f)(const void *state);
+
+/* Initial condition function
+ *
+ * This function assigns (random) initial conditions to a game state whose
+ * parameters have already been set. Games which need memory beyond their state
+ * struct allocate it here.
+ *
+ * Parameters:
+ * - state: The private state (containing state variables) of the dynamic system
+ * - w: The width of the arena in meters
+ * - h: The height of the arena in meters
+ * - rng: The random number generator, advanced as values are drawn
+ *
+ * Returns: False if the state could not be initialized, true otherwise.
+ */
+typedef bool (*game_init_f)(void *state, double w, double h, rng_t *rng);
+
+/* Release function
+ *
+ * Releases any resources acquired by the initial condition function.
+ *
+ * Parameters:
+ * - state: The private state (containing state variables) of the dynamic system
+ */
+typedef void (*game_free_f)(void *state);
+
+/* State variable function
+ *
+ * Locates the state variables of a game which are integrated with its state
+ * derivative. They are usually at the start of the game state, but games whose
+ * size depends on their parameters may keep them elsewhere.
+ *
+ * Parameters:
+ * - state: The private state (containing state variables) of the dynamic system
+ * - vars: Where to store a pointer to the state variables
+ *
+ * Returns: The number of state variables (scalars).
+ */
+typedef size_t (*state_vars_f)(void *state, real_t **vars);
+
+/* Game parameters
+ *
+ * Parameters are constants of a game (velocities, capture radii, number of
+ * agents) which live inside of the game state so that they can be changed by
+ * name without recompiling.
+ */
+
+enum param_type_e {
+  PARAM_DOUBLE, /* double */
+  PARAM_REAL,   /* real_t, for constants used alongside the state variables */
+  PARAM_SIZE,   /* size_t */
+};
+
+typedef struct {
+  const char *name;       /* Name used to set the parameter */
+  enum param_type_e type; /* Type of the field in the game state */
+  size_t offset;          /* Offset of the field in the game state */
+  double def;             /* Default value */
+} game_param_t;
+
+#define GAME_PARAM(p_type, p_field, p_kind, p_def)                             \
+  {                                                                            \
+      .name = #p_field,                                                        \
+      .type = (p_kind),                                                        \
+      .offset = offsetof(p_type, p_field),                                     \
+      .def = (p_def),                                                          \
+  }
+
+/* Batched terminal condition function
+ *
+ * Ends the instances of a batch whose games are over. Ended instances must be
+ * frozen by the game's batched functions from then on. Games with a terminal
+ * event should end their instances at the time of the event, as located by the
+ * unbatched game, rather than at the end of the step in which it happened.
+ *
+ * Parameters:
+ * - state: The private state of all instances
+ * - k: The number of instances
+ * - t: The current simulated time
+ * - t_end: The termination time of each instance, set for instances which
+ *          ended during the last step (at most `t`) and left untouched
+ *          otherwise
+ *
+ * Returns: The number of instances which are still running.
+ */
+typedef size_t (*batch_term_cond_f)(void *state, size_t k, double t,
+                                    double *t_end);
+
+/* Batched initial condition function
+ *
+ * Allocates the arrays of a batch and assigns random initial conditions to
+ * every instance. Instances draw their random values one after the other, in
+ * the same order as the game's unbatched initial condition function.
+ *
+ * Parameters:
+ * - state: The private state of all instances
+ * - tmpl: An unbatched game state holding the parameters of the game
+ * - k: The number of instances
+ * - w: The width of the arena in meters
+ * - h: The height of the arena in meters
+ * - rng: The random number generator, advanced as values are drawn
+ *
+ * Returns: False if the batch could not be initialized, true otherwise.
+ */
+typedef bool (*game_batch_init_f)(void *state, const void *tmpl, size_t k,
+                                  double w, double h, rng_t *rng);
+
+/* Description of the batched (structure of arrays) variant of a game */
+
+typedef struct {
+  size_t size;            /* Size of the batched game state in bytes */
+  game_batch_init_f init; /* Initial conditions, allocates the arrays */
+  game_free_f free;       /* Releases the arrays */
+  batch_dynamics_f f;     /* Dynamics function f(X, t) */
+  batch_control_f u;      /* Control function u(t) */
+  batch_run_cost_f g;     /* Running cost function l(X, t) */
+  batch_term_cost_f q;    /* Terminal cost function q(X) */
+  batch_term_cond_f done; /* Terminal condition */
+} game_batch_desc_t;
+
+/* Description of a game which can be simulated without a front-end */
+
+typedef struct {
+  const char *name;               /* Name of the game */
+  size_t size;                    /* Size of the game state in bytes */
+  double dt;                      /* Default time-step */
+  const game_param_t *params;     /* Tunable parameters */
+  size_t n_params;                /* Number of tunable parameters */
+  game_init_f init;               /* Initial conditions */
+  game_free_f free;               /* Resource release, may be NULL */
+  state_copy_f copy;              /* Copies a state, NULL if memcpy will do */
+  state_save_f save;              /* Saves the memory a state points to */
+  state_restore_f restore;        /* Restores the memory a state points to */
+  dynamics_f f;                   /* Dynamics function f(x, t) */
+  deriv_f d;                      /* State derivative, used instead of f */
+  state_vars_f vars;              /* State variables integrated with d */
+  size_t agent_vars;              /* State variables per agent, 0 if none */
+  enum integrator_e method;       /* Default integration method used with d */
+  dynsys_step_f step;             /* Step specialized for d, may be NULL */
+  control_tf u;                   /* Control function u(x, t) */
+  run_cost_tf g;                  /* Running cost function l(x, t) */
+  term_cost_f q;                  /* Terminal cost function q(x) */
+  term_cond_f done;               /* Terminal condition, NULL to run forever */
+  event_f event;                  /* Terminal event, located exactly if set */
+  event_rate_f event_rate;        /* Bound of the event's rate, may be NULL */
+  const game_batch_desc_t *batch; /* Batched variant, may be NULL */
+} game_desc_t;
+
+/* game_params_default
+ *
+ * Sets every parameter of the game state to its default value.
+ *
+ * Parameters:
+ * - g: The game description
+ * - x: The game state
+ */
+void game_params_default(const game_desc_t *g, void *x);
+
+/* game_param_set
+ *
+ * Sets a single parameter of the game state by name.
+ *
+ * Parameters:
+ * - g: The game description
+ * - x: The game state
+ * - name: The name of the parameter
+ * - val: The value to assign
+ *
+ * Returns: False if the game has no parameter called `name`, true otherwise.
+ */
+bool game_param_set(const game_desc_t *g, void *x, const char *name,
+                    double val);
+
+/* game_param_get
+ *
+ * Gets the value of a single parameter of the game state by name.
+ *
+ * Parameters:
+ * - g: The game description
+ * - x: The game state
+ * - name: The name of the parameter
+ * - val: Where to store the value
+ *
+ * Returns: False if the game has no parameter called `name`, true otherwise.
+ */
+bool game_param_get(const game_desc_t *g, const void *x, const char *name,
+                    double *val);
+
+/* game_dynsys_init
+ *
+ * Initializes a dynamic system with the functions of a game. Games with a state
+ * derivative are integrated with their default method; the system must be
+ * released with `dynsys_free`. The game's terminal event, if any, is located to
+ * within `DYNSYS_EVENT_TOL`, using the bound of its rate if the game has one,
+ * and the game's specialized step is used if it has one. The system knows the
+ * size of the game state, so it can be snapshot and forked.
+ *
+ * Parameters:
+ * - g: The game description
+ * - s: The dynamic system to initialize
+ * - x: The game state
+ *
+ * Returns: False if the system could not be initialized, true otherwise.
+ */
+bool game_dynsys_init(const game_desc_t *g, dynsys_t *s, void *x);
+
+/* Results of a headless run */
+
+typedef struct {
+  double t;             /* Simulated time at the end of the run */
+  double cost;          /* Total system cost at the end of the run */
+  unsigned long steps;  /* Number of time-steps taken */
+  bool terminated;      /* True if the terminal condition ended the run */
+  double wall;          /* Wall-clock time of the run in seconds */
+  double steps_per_sec; /* Simulation throughput */
+} headless_result_t;
+
+/* headless_run
+ *
+ * Steps a dynamic system forward in time as fast as possible, until either its
+ * terminal condition is met, its terminal event happens or the time limit is
+ * reached. Systems integrated with `INTEGRATOR_RK45` are stepped with
+ * `dynsys_step_adaptive`, so that the step sizes follow the dynamics, and their
+ * controls are updated every `dt` unless they have a control period, so that
+ * they end at the same time as with the fixed-step methods.
+ *
+ * Parameters:
+ * - s: The dynamic system to run
+ * - done: The terminal condition. If NULL, the system runs until `t_max`
+ * - dt: The time-step, only the control period of adaptive systems
+ * - t_max: The simulated time limit
+ * - res: Where to store the results of the run
+ */
+void headless_run(dynsys_t *s, term_cond_f done, double dt, double t_max,
+                  headless_result_t *res);
+
+/* Results of a headless batched run */
+
+typedef struct {
+  double t;             /* Simulated time at the end of the run */
+  unsigned long steps;  /* Number of batch time-steps taken */
+  size_t n_terminated;  /* Number of instances ended by terminal condition */
+  double wall;          /* Wall-clock time of the run in seconds */
+  double steps_per_sec; /* Simulation throughput in instance time-steps */
+} headless_batch_result_t;
+
+/* headless_batch_run
+ *
+ * Steps a batch of dynamic systems forward in time as fast as possible, until
+ * either every instance met the terminal condition or the time limit is
+ * reached.
+ *
+ * Parameters:
+ * - s: The batch to run
+ * - done: The batched terminal condition
+ * - dt: The time-step
+ * - t_max: The simulated time limit
+ * - t_end: The termination time of each instance, `k` entries. Instances which
+ *          didn't terminate are given a negative time.
+ * - res: Where to store the results of the run
+ */
+void headless_batch_run(dynsys_batch_t *s, batch_term_cond_f done, double dt,
+                        double t_max, double *t_end,
+                        headless_batch_result_t *res);
+
+/* headless_now
+ *
+ * Returns: Monotonic wall-clock time in seconds
+ */
+double headless_now(void);
+
+#endif // DIFFGAMES_HEADLESS_H
@@ -0,0 +1,92 @@
+#ifndef DIFFGAMES_MONTECARLO_H
+#define DIFFGAMES_MONTECARLO_H
+
+/* Included files */
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "headless.h"
+
+/* Monte Carlo engine
+ *
+ * Runs many independent games from random initial conditions across all cores.
+ * Every worker thread owns its own game state, which is re-used from run to
+ * run. Runs are split evenly between the workers up front; a worker which runs
+ * out of work steals half of the remaining runs of another worker.
+ *
+ * The game's functions are called concurrently from several threads, so they
+ * must not keep any state outside of the game state.
+ */
+
+/* Configuration of a batch of runs */
+
+typedef struct {
+  const game_desc_t *game; /* The game to run */
+  const void *tmpl;        /* Game state with parameters set, may be NULL */
+  double w;                /* Arena width in meters */
+  double h;                /* Arena height in meters */
+  double dt;               /* Time-step */
+  double t_max;            /* Simulated time limit of each run */
+  unsigned seed;           /* Base seed, run i is seeded with `seed + i` */
+  size_t n_runs;           /* Number of runs */
+  unsigned n_threads;      /* Number of worker threads, 0 for one per CPU */
+} mc_config_t;
+
+/* Result of a single run */
+
+typedef struct {
+  unsigned seed;       /* Seed of the run's initial conditions */
+  bool ok;             /* False if the game could not be initialized */
+  bool terminated;     /* True if the terminal condition ended the run */
+  unsigned long steps; /* Number of time-steps taken */
+  double t;            /* Simulated time at the end of the run */
+  double cost;         /* Total system cost at the end of the run */
+} mc_result_t;
+
+/* Statistics over a batch of runs */
+
+typedef struct {
+  size_t n_runs;        /* Number of runs which could be initialized */
+  size_t n_terminated;  /* Number of runs which ended by terminal condition */
+  double p_terminated;  /* Fraction of runs which ended by terminal condition */
+  double mean_t;        /* Mean termination time of the terminated runs */
+  double mean_cost;     /* Mean cost of all runs */
+  unsigned long steps;  /* Total number of time-steps taken */
+  double wall;          /* Wall-clock time of the batch in seconds */
+  double steps_per_sec; /* Simulation throughput over all threads */
+} mc_summary_t;
+
+/* mc_run
+ *
+ * Runs a batch of games in parallel.
+ *
+ * Parameters:
+ * - cfg: The configuration of the batch
+ * - results: Buffer of `cfg->n_runs` results, indexed by run number
+ * - summary: Where to store statistics over the batch, may be NULL
+ *
+ * Returns: False if the worker threads could not be started, true otherwise.
+ */
+bool mc_run(const mc_config_t *cfg, mc_result_t *results,
+            mc_summary_t *summary);
+
+/* mc_summarize
+ *
+ * Computes statistics over the results of a batch. The wall-clock time and
+ * throughput are left as zero.
+ *
+ * Parameters:
+ * - results: The results of the batch
+ * - n: The number of results
+ * - summary: Where to store the statistics
+ */
+void mc_summarize(const mc_result_t *results, size_t n, mc_summary_t *summary);
+
+/* mc_nprocs
+ *
+ * Returns: The number of online CPUs
+ */
+unsigned mc_nprocs(void);
+
+#endif // DIFFGAMES_MONTECARLO_H
@@ -0,0 +1,48 @@
+#ifndef DIFFGAMES_REAL_H
+#define DIFFGAMES_REAL_H
+
+/* Included files */
+
+#include <math.h>
+
+/* Scalar type
+ *
+ * Vectors and the state variables of dynamic systems are made of `real_t`,
+ * which is a double unless the library is built with `CONFIG_FLOAT` set (`make
+ * FLOAT=1`). Single precision halves the size of the state, so that twice as
+ * many variables fit in a vector register, a cache line or a snapshot, which
+ * is plenty for Monte Carlo statistics. Simulated time, costs and tolerances
+ * stay doubles in either build, since they accumulate over a whole run.
+ *
+ * The `real_*` functions are the math functions of the scalar type, so that
+ * float builds don't compute in double precision and convert back. The
+ * trigonometric ones are in trig.h.
+ */
+
+#ifndef CONFIG_FLOAT
+#define CONFIG_FLOAT (0)
+#endif
+
+#if CONFIG_FLOAT
+
+typedef float real_t;
+
+#define REAL_NAME "float"
+#define real_sqrt sqrtf
+#define real_fabs fabsf
+#define real_fmin fminf
+#define real_fmax fmaxf
+
+#else
+
+typedef double real_t;
+
+#define REAL_NAME "double"
+#define real_sqrt sqrt
+#define real_fabs fabs
+#define real_fmin fmin
+#define real_fmax fmax
+
+#endif
+
+#endif // DIFFGAMES_REAL_H
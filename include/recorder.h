@@ -0,0 +1,201 @@
+#ifndef DIFFGAMES_RECORDER_H
+#define DIFFGAMES_RECORDER_H
+
+/* Included files */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "real.h"
+
+/* Trajectory recorder
+ *
+ * Records the state variables of a dynamic system after every step into a
+ * binary file. The file is sized for `capacity` records up front and mapped
+ * into memory, so that appending a record is a copy into the mapping without
+ * any system calls or allocations. A full file is doubled, and mapped again, up
+ * to `max_capacity` records; records which don't fit in that are dropped.
+ * Closing the recorder trims the file to the records which were written.
+ *
+ * The file starts with a `recorder_header_t`, followed by the records. Every
+ * record is the simulated time as a native double, followed by the `n_vars`
+ * state variables as native scalars (`real_t`, see `var_size`), padded to a
+ * whole number of doubles. The state variables are `n_agents` blocks of
+ * `agent_vars` variables, in the order of the game's state variables;
+ * `n_agents` is 0 for games which aren't made of agents.
+ */
+
+#define RECORDER_MAGIC "DGTRAJ"
+#define RECORDER_VERSION (2)
+#define RECORDER_NAME_LEN (32)
+
+/* Doubles per record of `n_vars` state variables */
+
+#define RECORDER_STRIDE(n_vars)                                                \
+  (1 + ((n_vars) * sizeof(real_t) + sizeof(double) - 1) / sizeof(double))
+
+typedef struct {
+  char magic[8];                /* `RECORDER_MAGIC`, NUL padded */
+  uint32_t version;             /* `RECORDER_VERSION` */
+  uint32_t header_size;         /* Size of this header in bytes */
+  char game[RECORDER_NAME_LEN]; /* Name of the game, NUL padded */
+  uint64_t n_vars;              /* State variables per record */
+  uint64_t agent_vars;          /* State variables per agent */
+  uint64_t n_agents;            /* Number of agents */
+  uint64_t record_size;         /* Size of a record in bytes */
+  uint64_t n_records;           /* Number of records in the file */
+  double dt;                    /* Time-step, or largest step if adaptive */
+  uint64_t var_size;            /* Size of a state variable in bytes */
+} recorder_header_t;
+
+typedef struct recorder {
+  int fd;             /* The trajectory file */
+  void *map;          /* Mapping of the whole file */
+  size_t map_size;    /* Size of the mapping in bytes */
+  double *next;       /* Where the next record goes */
+  size_t n_vars;      /* State variables per record */
+  size_t stride;      /* Doubles per record */
+  uint64_t n_records; /* Records written */
+  uint64_t capacity;  /* Records which fit in the file */
+  uint64_t max_cap;   /* Records the file may grow to */
+  uint64_t dropped;   /* Records which didn't fit */
+  double t;           /* Simulated time of the last record */
+} recorder_t;
+
+/* recorder_open
+ *
+ * Creates a trajectory file, replacing any existing one, and maps it into
+ * memory.
+ *
+ * Parameters:
+ * - r: The recorder to open
+ * - path: The path of the trajectory file
+ * - game: The name of the game
+ * - n_vars: The number of state variables per record
+ * - agent_vars: The number of state variables per agent, 0 if there are no
+ *               agents
+ * - dt: The time-step
+ * - capacity: The number of records to make space for, at least 1
+ * - max_capacity: The most records the file may grow to, at least `capacity`
+ *
+ * Returns: False if the file could not be created or mapped, true otherwise.
+ */
+bool recorder_open(recorder_t *r, const char *path, const char *game,
+                   size_t n_vars, size_t agent_vars, double dt,
+                   uint64_t capacity, uint64_t max_capacity);
+
+/* recorder_grow
+ *
+ * Doubles the room for records of a full recorder, up to its largest capacity,
+ * by growing the file and mapping it again. Called by `recorder_append`.
+ *
+ * Parameters:
+ * - r: The recorder
+ *
+ * Returns: False if the recorder is at its largest capacity or could not grow,
+ * in which case it stops trying, true otherwise.
+ */
+bool recorder_grow(recorder_t *r);
+
+/* recorder_close
+ *
+ * Writes the number of records to the header, trims the file to them and
+ * closes it.
+ *
+ * Parameters:
+ * - r: The recorder
+ *
+ * Returns: False if the file could not be written, true otherwise.
+ */
+bool recorder_close(recorder_t *r);
+
+/* recorder_append
+ *
+ * Records the state variables after a step.
+ *
+ * Parameters:
+ * - r: The recorder
+ * - h: The simulated time advanced since the last record
+ * - v: The `n_vars` state variables
+ */
+static inline void recorder_append(recorder_t *r, double h, const real_t *v) {
+  r->t += h;
+  if (r->n_records == r->capacity && !recorder_grow(r)) {
+    r->dropped++;
+    return;
+  }
+
+  r->next[0] = r->t;
+  memcpy(r->next + 1, v, sizeof(real_t) * r->n_vars);
+  r->next += r->stride;
+  r->n_records++;
+}
+
+/* Recorded trajectory, mapped read-only */
+
+typedef struct {
+  int fd;                       /* The trajectory file */
+  const void *map;              /* Mapping of the whole file */
+  size_t map_size;              /* Size of the mapping in bytes */
+  const recorder_header_t *hdr; /* Header of the file */
+  const double *records;        /* First record */
+  size_t stride;                /* Doubles per record */
+  uint64_t n;                   /* Number of records */
+} trajectory_t;
+
+/* trajectory_open
+ *
+ * Maps a trajectory file written by a recorder into memory. Nothing is read
+ * until records are accessed.
+ *
+ * Parameters:
+ * - t: The trajectory to open
+ * - path: The path of the trajectory file
+ *
+ * Returns: False if the file could not be mapped, isn't a trajectory file or
+ * holds no records, true otherwise.
+ */
+bool trajectory_open(trajectory_t *t, const char *path);
+
+/* trajectory_close
+ *
+ * Unmaps a trajectory file.
+ *
+ * Parameters:
+ * - t: The trajectory
+ */
+void trajectory_close(trajectory_t *t);
+
+/* trajectory_seek
+ *
+ * Finds the record showing the state at a given time, by binary search.
+ *
+ * Parameters:
+ * - t: The trajectory
+ * - time: The simulated time
+ *
+ * Returns: The index of the last record at or before `time`, 0 if `time` is
+ * before the first record.
+ */
+uint64_t trajectory_seek(const trajectory_t *t, double time);
+
+/* trajectory_time
+ *
+ * Returns: The simulated time of record `i`
+ */
+static inline double trajectory_time(const trajectory_t *t, uint64_t i) {
+  return t->records[i * t->stride];
+}
+
+/* trajectory_vars
+ *
+ * Returns: The state variables of record `i`
+ */
+static inline const real_t *trajectory_vars(const trajectory_t *t,
+                                            uint64_t i) {
+  return (const real_t *)(t->records + i * t->stride + 1);
+}
+
+#endif // DIFFGAMES_RECORDER_H
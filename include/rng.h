@@ -0,0 +1,144 @@
+#ifndef DIFFGAMES_RNG_H
+#define DIFFGAMES_RNG_H
+
+/* Included files */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "real.h"
+
+/* Random number generator
+ *
+ * xoshiro256** by Blackman and Vigna: 256 bits of state, a period of 2^256 - 1
+ * and a handful of shifts and rotations per number. Every generator owns its
+ * state, so threads and runs each use their own generator without any locking,
+ * and the same seed always gives the same numbers on every platform.
+ *
+ * Independent streams come either from different seeds, which are spread over
+ * the state by splitmix64 so that consecutive seeds aren't correlated, or from
+ * a single seed by jumping ahead, which guarantees the streams never overlap.
+ */
+
+typedef struct {
+  uint64_t s[4]; /* Must not be all zero, which `rng_seed` ensures */
+} rng_t;
+
+/* rng_seed
+ *
+ * Seeds a generator.
+ *
+ * Parameters:
+ * - r: The generator to seed
+ * - seed: Any value, including 0
+ */
+void rng_seed(rng_t *r, uint64_t seed);
+
+/* rng_jump
+ *
+ * Advances a generator by 2^128 numbers, as if that many were drawn.
+ *
+ * Parameters:
+ * - r: The generator
+ */
+void rng_jump(rng_t *r);
+
+/* rng_long_jump
+ *
+ * Advances a generator by 2^192 numbers, as if that many were drawn. Every
+ * long jump starts room for 2^64 streams made with `rng_jump`.
+ *
+ * Parameters:
+ * - r: The generator
+ */
+void rng_long_jump(rng_t *r);
+
+/* rng_split
+ *
+ * Hands out a substream of 2^128 numbers which doesn't overlap with any other
+ * substream split off the same generator, i.e. one per thread.
+ *
+ * Parameters:
+ * - r: The generator to split, advanced past the substream
+ * - sub: The generator of the substream
+ */
+void rng_split(rng_t *r, rng_t *sub);
+
+/* rng_fill
+ *
+ * Draws random scalars in [min, max) into an array, i.e. state variables, the
+ * same numbers as drawing them one at a time with `rng_uniform`.
+ *
+ * Parameters:
+ * - r: The generator
+ * - out: Where to store the numbers
+ * - n: The number of numbers to draw
+ * - min: The lower bound
+ * - max: The upper bound
+ */
+void rng_fill(rng_t *r, real_t *out, size_t n, double min, double max);
+
+/* rng_fill_strided
+ *
+ * Like `rng_fill`, but stores the numbers `stride` scalars apart, i.e. into
+ * one field of an array of structs.
+ *
+ * Parameters:
+ * - r: The generator
+ * - out: Where to store the first number
+ * - n: The number of numbers to draw
+ * - stride: The distance between numbers, in scalars
+ * - min: The lower bound
+ * - max: The upper bound
+ */
+void rng_fill_strided(rng_t *r, real_t *out, size_t n, size_t stride,
+                      double min, double max);
+
+static inline uint64_t rng_rotl(uint64_t x, int k) {
+  return (x << k) | (x >> (64 - k));
+}
+
+/* rng_next
+ *
+ * Returns: The next 64 random bits
+ */
+static inline uint64_t rng_next(rng_t *r) {
+  uint64_t *s = r->s;
+  uint64_t out = rng_rotl(s[1] * 5, 7) * 9;
+  uint64_t t = s[1] << 17;
+
+  s[2] ^= s[0];
+  s[3] ^= s[1];
+  s[1] ^= s[2];
+  s[0] ^= s[3];
+  s[2] ^= t;
+  s[3] = rng_rotl(s[3], 45);
+
+  return out;
+}
+
+/* rng_double
+ *
+ * Returns: A random double in [0, 1), from the upper 53 random bits
+ */
+static inline double rng_double(rng_t *r) {
+  return (rng_next(r) >> 11) * 0x1.0p-53;
+}
+
+/* rng_uniform
+ *
+ * Returns: A random double in [min, max)
+ */
+static inline double rng_uniform(rng_t *r, double min, double max) {
+  return min + (max - min) * rng_double(r);
+}
+
+/* rng_index
+ *
+ * Returns: A random index in [0, n)
+ */
+static inline size_t rng_index(rng_t *r, size_t n) {
+  return (size_t)(rng_double(r) * n);
+}
+
+#endif // DIFFGAMES_RNG_H
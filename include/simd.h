@@ -0,0 +1,59 @@
+#ifndef DIFFGAMES_SIMD_H
+#define DIFFGAMES_SIMD_H
+
+/* Kernels over arrays
+ *
+ * A kernel is written once, as a plain loop over arrays in a `SIMD_INLINE`
+ * function named `<name>_k`, and `SIMD_KERNEL()` defines the public function
+ * `<name>` from it. The kernel is inlined into one function per instruction
+ * set, which the compiler vectorizes for that instruction set: the build's
+ * target, and AVX2 on x86, which is picked when the CPU supports it. FMA is
+ * left out on purpose, since contracting the products would round differently
+ * from the scalar code, and results would depend on the CPU.
+ *
+ * Loops which access more than a few arrays aren't vectorized, since GCC gives
+ * up when it would have to check too many pairs of arrays for overlap at
+ * run-time; such kernels are better split into one loop per output.
+ */
+
+#if defined(__GNUC__)
+#define SIMD_INLINE static inline __attribute__((always_inline))
+#else
+#define SIMD_INLINE static inline
+#endif
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+
+#define SIMD_HAS_AVX2 (__builtin_cpu_supports("avx2"))
+
+#define SIMD_KERNEL(name, params, args)                                        \
+  __attribute__((target("avx2"))) static void name##_avx2 params {             \
+    name##_k args;                                                             \
+  }                                                                            \
+                                                                               \
+  void name params {                                                           \
+    if (SIMD_HAS_AVX2) {                                                       \
+      name##_avx2 args;                                                        \
+    } else {                                                                   \
+      name##_k args;                                                           \
+    }                                                                          \
+  }
+
+#else
+
+#define SIMD_HAS_AVX2 (0)
+
+#define SIMD_KERNEL(name, params, args)                                        \
+  void name params { name##_k args; }
+
+#endif
+
+/* Name of the instruction set the kernels use on this CPU */
+
+#if defined(__x86_64__)
+#define SIMD_ISA (SIMD_HAS_AVX2 ? "avx2" : "sse2")
+#else
+#define SIMD_ISA (SIMD_HAS_AVX2 ? "avx2" : "generic")
+#endif
+
+#endif // DIFFGAMES_SIMD_H
@@ -0,0 +1,71 @@
+#ifndef DIFFGAMES_SIMLOOP_H
+#define DIFFGAMES_SIMLOOP_H
+
+/* Included files */
+
+#include <stdbool.h>
+
+#include "dynsys.h"
+#include "headless.h"
+
+/* Real-time simulation loop
+ *
+ * Front-ends render one frame per display refresh. The simulation loop
+ * decouples the simulation from the frame rate: every frame, it advances the
+ * system by the wall-clock time passed since the previous frame, scaled by a
+ * real-time factor, in fixed time-steps. Time which doesn't make up a whole
+ * time-step is carried over to the next frame. Only the state at the end of
+ * the frame is rendered.
+ */
+
+#define SIMLOOP_FAST (0.0) /* Real-time factor to run as fast as possible */
+
+#define SIMLOOP_MAX_LAG (0.25) /* Most wall-clock seconds caught up per frame */
+#define SIMLOOP_BUDGET (0.015) /* Wall-clock seconds per frame when fast */
+
+typedef struct {
+  double dt;   /* Time-step */
+  double rate; /* Simulated seconds per wall-clock second, or SIMLOOP_FAST */
+  double lag;  /* Simulated time owed to the system */
+  double last; /* Wall-clock time of the previous frame */
+  double t;    /* Simulated time */
+  bool over;   /* True once the game has ended */
+} simloop_t;
+
+/* simloop_init
+ *
+ * Initializes a simulation loop.
+ *
+ * Parameters:
+ * - l: The simulation loop to initialize
+ * - dt: The time-step
+ * - rate: The real-time factor, `SIMLOOP_FAST` to run as fast as possible
+ */
+void simloop_init(simloop_t *l, double dt, double rate);
+
+/* simloop_reset
+ *
+ * Restarts the simulated time of a loop, i.e. when the game is restarted.
+ *
+ * Parameters:
+ * - l: The simulation loop
+ */
+void simloop_reset(simloop_t *l);
+
+/* simloop_advance
+ *
+ * Advances a dynamic system by the time passed since the last frame. When
+ * running as fast as possible, steps are taken for `SIMLOOP_BUDGET` seconds.
+ * The loop is over once the terminal condition is met or the system's terminal
+ * event happens, after which no more steps are taken.
+ *
+ * Parameters:
+ * - l: The simulation loop
+ * - s: The dynamic system to advance
+ * - done: The terminal condition, may be NULL
+ *
+ * Returns: The number of time-steps taken.
+ */
+unsigned long simloop_advance(simloop_t *l, dynsys_t *s, term_cond_f done);
+
+#endif // DIFFGAMES_SIMLOOP_H
@@ -0,0 +1,116 @@
+#ifndef DIFFGAMES_SIMTHREAD_H
+#define DIFFGAMES_SIMTHREAD_H
+
+/* Included files */
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "dynsys.h"
+#include "headless.h"
+#include "simloop.h"
+#include "tribuf.h"
+
+/* Simulation thread
+ *
+ * Runs a simulation loop on its own thread, so that expensive controllers
+ * don't stall rendering and input. After every batch of time-steps, the thread
+ * publishes a snapshot of whatever the front-end needs to draw through a
+ * triple buffer; the front-end draws the newest snapshot every frame. The game
+ * state itself belongs to the simulation thread while it runs.
+ */
+
+#define SIMTHREAD_IDLE (0.01) /* Seconds to sleep between checks once over */
+
+/* Copies what gets rendered out of the game state into a snapshot */
+
+typedef void (*snapshot_f)(void *dst, const void *state);
+
+/* Restarts the game, i.e. with new random initial conditions */
+
+typedef bool (*restart_f)(void *ctx);
+
+/* A snapshot, as seen by the front-end */
+
+typedef struct {
+  unsigned long gen;  /* Number of restarts before the snapshot was taken */
+  double t;           /* Simulated time */
+  bool over;          /* True once the game has ended */
+  max_align_t data[]; /* Snapshot of the game state */
+} simthread_snap_t;
+
+/* Configuration of a simulation thread */
+
+typedef struct {
+  dynsys_t *s;       /* The dynamic system to advance */
+  term_cond_f done;  /* The terminal condition, may be NULL */
+  double dt;         /* Time-step */
+  double rate;       /* Real-time factor, `SIMLOOP_FAST` to run flat out */
+  size_t snap_size;  /* Size of the game's snapshot in bytes */
+  snapshot_f snap;   /* Takes a snapshot of the game state */
+  restart_f restart; /* Restarts the game, may be NULL */
+  void *ctx;         /* Passed to `restart` */
+} simthread_cfg_t;
+
+typedef struct {
+  simthread_cfg_t cfg;   /* Configuration */
+  simloop_t loop;        /* Pacing of the simulation */
+  tribuf_t snaps;        /* Snapshots passed to the front-end */
+  unsigned long gen;     /* Restarts done by the simulation thread */
+  atomic_ulong restarts; /* Restarts requested by the front-end */
+  atomic_bool quit;      /* Set to stop the simulation thread */
+  atomic_bool failed;    /* Set if a restart failed */
+  pthread_t thread;      /* Simulation thread */
+} simthread_t;
+
+/* simthread_start
+ *
+ * Takes a first snapshot of the game, then starts simulating it on a new
+ * thread.
+ *
+ * Parameters:
+ * - t: The simulation thread to start
+ * - cfg: The configuration of the simulation thread
+ *
+ * Returns: False if the snapshots could not be allocated or the thread could
+ * not be started, true otherwise.
+ */
+bool simthread_start(simthread_t *t, const simthread_cfg_t *cfg);
+
+/* simthread_stop
+ *
+ * Stops a simulation thread and waits for it to exit. The game state belongs
+ * to the caller again afterwards.
+ *
+ * Parameters:
+ * - t: The simulation thread
+ */
+void simthread_stop(simthread_t *t);
+
+/* simthread_restart
+ *
+ * Asks the simulation thread to restart the game. Snapshots of the restarted
+ * game carry the returned generation; older ones may still be seen for a frame
+ * or so.
+ *
+ * Parameters:
+ * - t: The simulation thread
+ *
+ * Returns: The generation of the restarted game.
+ */
+unsigned long simthread_restart(simthread_t *t);
+
+/* simthread_latest
+ *
+ * Gets the newest snapshot. The snapshot stays valid until the next call.
+ *
+ * Parameters:
+ * - t: The simulation thread
+ *
+ * Returns: The newest snapshot.
+ */
+const simthread_snap_t *simthread_latest(simthread_t *t);
+
+#endif // DIFFGAMES_SIMTHREAD_H
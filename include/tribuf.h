@@ -0,0 +1,84 @@
+#ifndef DIFFGAMES_TRIBUF_H
+#define DIFFGAMES_TRIBUF_H
+
+/* Included files */
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/* Lock-free triple buffer
+ *
+ * Passes snapshots of a fixed size from a single writer thread to a single
+ * reader thread. The writer fills the back buffer and publishes it by swapping
+ * it with the middle buffer; the reader takes the middle buffer by swapping it
+ * with the front buffer, but only if something new was published. Neither side
+ * ever waits for the other: the writer may publish many snapshots between two
+ * reads, in which case the reader only sees the newest one.
+ */
+
+typedef struct {
+  void *buf[3];         /* The three buffers */
+  size_t size;          /* Size of each buffer in bytes */
+  unsigned back;        /* Index of the buffer owned by the writer */
+  unsigned front;       /* Index of the buffer owned by the reader */
+  _Atomic unsigned mid; /* Index of the middle buffer, and a fresh flag */
+} tribuf_t;
+
+/* tribuf_init
+ *
+ * Initializes a triple buffer with zeroed buffers. The front buffer may be
+ * read right away.
+ *
+ * Parameters:
+ * - b: The triple buffer to initialize
+ * - size: The size of a snapshot in bytes
+ *
+ * Returns: False if the buffers could not be allocated, true otherwise.
+ */
+bool tribuf_init(tribuf_t *b, size_t size);
+
+/* tribuf_free
+ *
+ * Releases the buffers of a triple buffer.
+ *
+ * Parameters:
+ * - b: The triple buffer
+ */
+void tribuf_free(tribuf_t *b);
+
+/* tribuf_back
+ *
+ * Gets the buffer the writer may fill with the next snapshot. Only to be called
+ * by the writer.
+ *
+ * Parameters:
+ * - b: The triple buffer
+ *
+ * Returns: The back buffer.
+ */
+void *tribuf_back(tribuf_t *b);
+
+/* tribuf_publish
+ *
+ * Publishes the back buffer as the newest snapshot. The writer gets a new back
+ * buffer, which holds an older snapshot. Only to be called by the writer.
+ *
+ * Parameters:
+ * - b: The triple buffer
+ */
+void tribuf_publish(tribuf_t *b);
+
+/* tribuf_front
+ *
+ * Gets the newest published snapshot. The snapshot stays valid until the next
+ * call. Only to be called by the reader.
+ *
+ * Parameters:
+ * - b: The triple buffer
+ *
+ * Returns: The front buffer.
+ */
+const void *tribuf_front(tribuf_t *b);
+
+#endif // DIFFGAMES_TRIBUF_H
@@ -0,0 +1,224 @@
+#ifndef DIFFGAMES_TRIG_H
+#define DIFFGAMES_TRIG_H
+
+/* Included files */
+
+#include <math.h>
+#include <stddef.h>
+
+#include "real.h"
+
+/* Trigonometric functions of the scalar type
+ *
+ * `real_sin`, `real_cos`, `real_sincos` and `real_atan2` are the math library's
+ * functions of the scalar type, unless the library is built with
+ * `CONFIG_FAST_TRIG` set (`make FASTTRIG=1`). They are then the approximations
+ * below, which are inlined, have no branches, and so vectorize in loops over
+ * many angles, at the cost of the error bounds given with each of them.
+ *
+ * `real_sincos` computes the sine and cosine of the same angle at once: GCC
+ * turns the two calls into a single call to sincos() on glibc, and the
+ * approximation shares the range reduction.
+ */
+
+#ifndef CONFIG_FAST_TRIG
+#define CONFIG_FAST_TRIG (0)
+#endif
+
+/* Approximation constants
+ *
+ * Angles are reduced to r in [-pi/4, pi/4] from the nearest multiple k of
+ * pi/2, which is found by adding and subtracting 1.5 * 2^52 (2^23 for floats):
+ * this rounds to the nearest integer without a branch or a libm call, as long
+ * as the math isn't reassociated (no -ffast-math). pi/2 is split in parts
+ * with trailing zeros, so that k times the leading parts is exact. The
+ * polynomials are those of Cephes.
+ */
+
+#if CONFIG_FLOAT
+
+#define TRIG_ROUND (12582912.0f)
+#define TRIG_2_PI (0.636619772367581343f)
+#define TRIG_PI_2_A (1.5703125f)
+#define TRIG_PI_2_B (4.837512969970703125e-4f)
+#define TRIG_PI_2_C (7.54978995489188216e-8f)
+
+#else
+
+#define TRIG_ROUND (6755399441055744.0)
+#define TRIG_2_PI (0.636619772367581343)
+#define TRIG_PI_2_A (1.57079632673412561417)
+#define TRIG_PI_2_B (6.07710050650619224932e-11)
+#define TRIG_PI_2_C (0.0)
+
+#endif
+
+#define TRIG_K_MAX ((real_t)1073741824.0) /* 2^30, the largest quadrant index */
+#define TRIG_PI_2 ((real_t)1.57079632679489661923)
+#define TRIG_PI ((real_t)3.14159265358979323846)
+
+/* trig_fast_sincos
+ *
+ * Approximates the sine and cosine of an angle. For |x| <= 1e5, the error is
+ * at most 2 ulp in double precision, and 8e-8 in single precision (1e-6 beyond
+ * |x| = 1e4). It grows with |x| beyond, as the range reduction loses bits, to
+ * 6e-8 at |x| = 1e9 in double precision. Larger angles, and any beyond 1e5 in
+ * single precision, give meaningless results, though never undefined behavior;
+ * infinities and NaN give NaN.
+ *
+ * Parameters:
+ * - x: Angle in radians
+ * - s: Where to store the sine
+ * - c: Where to store the cosine
+ */
+static inline void trig_fast_sincos(real_t x, real_t *s, real_t *c) {
+  real_t k = (x * TRIG_2_PI + TRIG_ROUND) - TRIG_ROUND;
+  real_t r = ((x - k * TRIG_PI_2_A) - k * TRIG_PI_2_B) - k * TRIG_PI_2_C;
+  real_t z = r * r;
+
+  /* Only the last two bits of k are used, but converting it to an int is
+   * undefined unless it fits, so it is clamped first. The comparisons also turn
+   * a NaN into a valid index, while r carries the NaN into the result.
+   */
+
+  real_t kq = k < TRIG_K_MAX ? k : TRIG_K_MAX;
+  kq = kq > -TRIG_K_MAX ? kq : -TRIG_K_MAX;
+  int q = (int)kq;
+
+#if CONFIG_FLOAT
+  real_t sr = ((-1.9515295891e-4f * z + 8.3321608736e-3f) * z -
+               1.6666654611e-1f) *
+                  z * r +
+              r;
+  real_t cr = ((2.443315711809948e-5f * z - 1.388731625493765e-3f) * z +
+               4.166664568298827e-2f) *
+                  z * z -
+              0.5f * z + 1.0f;
+#else
+  real_t sp = 1.58962301576546568060e-10;
+  sp = sp * z - 2.50507477628578072866e-8;
+  sp = sp * z + 2.75573136213857245213e-6;
+  sp = sp * z - 1.98412698295895385996e-4;
+  sp = sp * z + 8.33333333332211858878e-3;
+  sp = sp * z - 1.66666666666666307295e-1;
+  real_t cp = -1.13585365213876817300e-11;
+  cp = cp * z + 2.08757008419747316778e-9;
+  cp = cp * z - 2.75573141792967388112e-7;
+  cp = cp * z + 2.48015872888517045348e-5;
+  cp = cp * z - 1.38888888888730564116e-3;
+  cp = cp * z + 4.16666666666665929218e-2;
+  real_t sr = r + r * z * sp;
+  real_t cr = 1.0 - 0.5 * z + z * z * cp;
+#endif
+
+  /* x = k * pi/2 + r, so the quadrant swaps and negates sin(r) and cos(r).
+   * Selecting by multiplying with 0, 1 or -1 is exact, and unlike a condition
+   * it is never compiled to a branch, which angles sweeping through the
+   * quadrants would mispredict.
+   */
+
+  real_t swap = (real_t)(q & 1);
+  real_t keep = 1 - swap;
+  *s = (real_t)(1 - (q & 2)) * (sr * keep + cr * swap);
+  *c = (real_t)(1 - ((q + 1) & 2)) * (cr * keep + sr * swap);
+}
+
+static inline real_t trig_fast_sin(real_t x) {
+  real_t s, c;
+  trig_fast_sincos(x, &s, &c);
+  return s;
+}
+
+static inline real_t trig_fast_cos(real_t x) {
+  real_t s, c;
+  trig_fast_sincos(x, &s, &c);
+  return c;
+}
+
+/* trig_fast_atan2
+ *
+ * Approximates the angle of the vector (x, y), in [-pi, pi], with the
+ * polynomial 4.4.49 of Abramowitz and Stegun for the arctangent on [0, 1]. The
+ * error is at most 2e-8 radians (3e-7 in single precision). Unlike atan2(),
+ * the angle of (0, 0) is always 0, and the sign of zeros is ignored.
+ *
+ * Parameters:
+ * - y: Ordinate of the vector
+ * - x: Abscissa of the vector
+ *
+ * Returns: The angle in radians
+ */
+static inline real_t trig_fast_atan2(real_t y, real_t x) {
+  real_t ax = real_fabs(x);
+  real_t ay = real_fabs(y);
+  real_t hi = ay > ax ? ay : ax;
+  real_t lo = ay > ax ? ax : ay;
+  real_t a = hi > 0 ? lo / hi : 0;
+  real_t z = a * a;
+
+  real_t p = (real_t)0.0028662257;
+  p = p * z - (real_t)0.0161657367;
+  p = p * z + (real_t)0.0429096138;
+  p = p * z - (real_t)0.0752896400;
+  p = p * z + (real_t)0.1065626393;
+  p = p * z - (real_t)0.1420889944;
+  p = p * z + (real_t)0.1999355085;
+  p = p * z - (real_t)0.3333314528;
+  real_t r = a + a * z * p;
+
+  /* Unfold the octant */
+
+  r = ay > ax ? TRIG_PI_2 - r : r;
+  r = x < 0 ? TRIG_PI - r : r;
+  return y < 0 ? -r : r;
+}
+
+/* Functions of the scalar type */
+
+#if CONFIG_FAST_TRIG
+
+#define TRIG_NAME "fast"
+#define real_sin trig_fast_sin
+#define real_cos trig_fast_cos
+#define real_sincos trig_fast_sincos
+#define real_atan2 trig_fast_atan2
+
+#else
+
+#if CONFIG_FLOAT
+#define real_sin sinf
+#define real_cos cosf
+#define real_atan2 atan2f
+#else
+#define real_sin sin
+#define real_cos cos
+#define real_atan2 atan2
+#endif
+
+#define TRIG_NAME "libm"
+
+static inline void real_sincos(real_t x, real_t *s, real_t *c) {
+  *s = real_sin(x);
+  *c = real_cos(x);
+}
+
+#endif
+
+/* The arcsine isn't approximated, since it's only used for conversions */
+
+#if CONFIG_FLOAT
+#define real_asin asinf
+#else
+#define real_asin asin
+#endif
+
+/* Batches of angles
+ *
+ * The same functions over arrays, which the compiler vectorizes when the fast
+ * approximations are used. The results may be written over the inputs.
+ */
+
+void trig_batch_sincos(const real_t *x, real_t *s, real_t *c, size_t n);
+void trig_batch_atan2(const real_t *y, const real_t *x, real_t *res, size_t n);
+
+#endif // DIFFGAMES_TRIG_H
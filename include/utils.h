@@ -13,10 +13,6 @@
 #define unreachable(msg) assert(0 && msg)
 #define todo(msg) assert(0 && "[TODO] " msg)
 
-/* Random double between min and max */
-
-#define randval(min, max) ((min) + (rand() / (RAND_MAX / ((max) - (min)))))
-
 /* Checking equality on floating point values */
 
 #define f_is_equal(exp, act, tol)                                              \
@@ -1,13 +1,14 @@
 #include <math.h>
 
 #include "3dtools.h"
+#include "trig.h"
 #include "utils.h"
 
-vec3d_t vec3d_init_r(double x, double y, double z) {
+vec3d_t vec3d_init_r(real_t x, real_t y, real_t z) {
   return (vec3d_t)VEC3D_SINIT(x, y, z);
 }
 
-void vec3d_init(vec3d_t *v, double x, double y, double z) {
+void vec3d_init(vec3d_t *v, real_t x, real_t y, real_t z) {
   v->x = x;
   v->y = y;
   v->z = z;
@@ -19,34 +20,38 @@ vec3d_t vec3d_add_r(vec3d_t *v1, vec3d_t *v2) {
   return res;
 }
 
-vec3d_t vec3d_scale_r(vec3d_t *v, double alpha) {
+vec3d_t vec3d_scale_r(vec3d_t *v, real_t alpha) {
   vec3d_t res;
   vec3d_scale(v, alpha, &res);
   return res;
 }
 
-double vec3d_dot_r(vec3d_t *v1, vec3d_t *v2) {
-  double res;
+real_t vec3d_dot_r(vec3d_t *v1, vec3d_t *v2) {
+  real_t res;
   vec3d_dot(v1, v2, res);
   return res;
 }
 
-void vec3d_rotate(vec3d_t *v, double angle, enum axis_e axis, vec3d_t *res) {
+void vec3d_rotate(vec3d_t *v, real_t angle, enum axis_e axis, vec3d_t *res) {
+  vec3d_t u = *v;
+  real_t s, c;
+
+  real_sincos(angle, &s, &c);
   switch (axis) {
   case AXIS_X:
-    res->x = v->x;
-    res->y = v->y * cos(angle) - v->z * sin(angle);
-    res->z = v->y * sin(angle) + v->z * cos(angle);
+    res->x = u.x;
+    res->y = u.y * c - u.z * s;
+    res->z = u.y * s + u.z * c;
     break;
   case AXIS_Y:
-    res->x = v->x * cos(angle) + v->z * sin(angle);
-    res->y = v->y;
-    res->z = v->x * -sin(angle) + v->z * cos(angle);
+    res->x = u.x * c + u.z * s;
+    res->y = u.y;
+    res->z = u.x * -s + u.z * c;
     break;
   case AXIS_Z:
-    res->x = v->x * cos(angle) - v->y * sin(angle);
-    res->y = v->x * sin(angle) + v->y * cos(angle);
-    res->z = v->z;
+    res->x = u.x * c - u.y * s;
+    res->y = u.x * s + u.y * c;
+    res->z = u.z;
     break;
   default:
     unreachable("No such axis.");
@@ -54,49 +59,50 @@ void vec3d_rotate(vec3d_t *v, double angle, enum axis_e axis, vec3d_t *res) {
   }
 }
 
-void vec3d_norm(vec3d_t *v, double *res) {
-  *res = sqrt((v->x * v->x) + (v->y * v->y) + (v->z * v->z));
+void vec3d_norm(vec3d_t *v, real_t *res) {
+  *res = real_sqrt((v->x * v->x) + (v->y * v->y) + (v->z * v->z));
 }
 
-double vec3d_norm_r(vec3d_t *v) {
-  double res;
+real_t vec3d_norm_r(vec3d_t *v) {
+  real_t res;
   vec3d_norm(v, &res);
   return res;
 }
 
-void vec3d_dist(vec3d_t *v1, vec3d_t *v3, double *res) {
-  vec3d_t reflect = vec3d_scale_r(v3, -1);
-  reflect = vec3d_add_r(v1, &reflect);
-  vec3d_norm(&reflect, res);
+void vec3d_dist(vec3d_t *v1, vec3d_t *v3, real_t *res) {
+  real_t dx = v1->x - v3->x;
+  real_t dy = v1->y - v3->y;
+  real_t dz = v1->z - v3->z;
+  *res = real_sqrt((dx * dx) + (dy * dy) + (dz * dz));
 }
 
-double vec3d_dist_r(vec3d_t *v1, vec3d_t *v3) {
-  double res;
+real_t vec3d_dist_r(vec3d_t *v1, vec3d_t *v3) {
+  real_t res;
   vec3d_dist(v1, v3, &res);
   return res;
 }
 
-vec3d_t vec3d_rotate_r(vec3d_t *v, double angle, enum axis_e axis) {
+vec3d_t vec3d_rotate_r(vec3d_t *v, real_t angle, enum axis_e axis) {
   vec3d_t res;
   vec3d_rotate(v, angle, axis, &res);
   return res;
 }
 
-void vec3d_project(vec3d_t *v, double camdist, vec2d_t *res) {
+void vec3d_project(vec3d_t *v, real_t camdist, vec2d_t *res) {
   /* TODO: verify */
   res->x = v->x / (v->z / camdist);
   res->y = v->y / (v->z / camdist);
 }
 
-vec2d_t vec3d_project_r(vec3d_t *v, double camdist) {
+vec2d_t vec3d_project_r(vec3d_t *v, real_t camdist) {
   vec2d_t res;
   vec3d_project(v, camdist, &res);
   return res;
 }
 
-vec2d_t vec2d_init_r(double x, double y) { return (vec2d_t)VEC2D_SINIT(x, y); }
+vec2d_t vec2d_init_r(real_t x, real_t y) { return (vec2d_t)VEC2D_SINIT(x, y); }
 
-void vec2d_init(vec2d_t *v, double x, double y) {
+void vec2d_init(vec2d_t *v, real_t x, real_t y) {
   v->x = x;
   v->y = y;
 }
@@ -107,36 +113,184 @@ vec2d_t vec2d_add_r(vec2d_t *v1, vec2d_t *v2) {
   return res;
 }
 
-vec2d_t vec2d_scale_r(vec2d_t *v, double alpha) {
+vec2d_t vec2d_scale_r(vec2d_t *v, real_t alpha) {
   vec2d_t res;
   vec2d_scale(v, alpha, &res);
   return res;
 }
 
-double vec2d_dot_r(vec2d_t *v1, vec2d_t *v2) {
-  double res;
+real_t vec2d_dot_r(vec2d_t *v1, vec2d_t *v2) {
+  real_t res;
   vec2d_dot(v1, v2, res);
   return res;
 }
 
-void vec2d_norm(vec2d_t *v, double *res) {
-  *res = sqrt(v->x * v->x + v->y * v->y);
+void vec2d_norm(vec2d_t *v, real_t *res) {
+  *res = real_sqrt(v->x * v->x + v->y * v->y);
 }
 
-double vec2d_norm_r(vec2d_t *v) {
-  double res;
+real_t vec2d_norm_r(vec2d_t *v) {
+  real_t res;
   vec2d_norm(v, &res);
   return res;
 }
 
-void vec2d_dist(vec2d_t *v1, vec2d_t *v2, double *res) {
-  vec2d_t reflect = vec2d_scale_r(v2, -1);
-  reflect = vec2d_add_r(v1, &reflect);
-  vec2d_norm(&reflect, res);
+void vec2d_dist(vec2d_t *v1, vec2d_t *v2, real_t *res) {
+  real_t dx = v1->x - v2->x;
+  real_t dy = v1->y - v2->y;
+  *res = real_sqrt(dx * dx + dy * dy);
 }
 
-double vec2d_dist_r(vec2d_t *v1, vec2d_t *v2) {
-  double res;
+real_t vec2d_dist_r(vec2d_t *v1, vec2d_t *v2) {
+  real_t res;
   vec2d_dist(v1, v2, &res);
   return res;
 }
+
+/* Rotations */
+
+void mat3d_from_euler(real_t roll, real_t pitch, real_t yaw, mat3d_t *res) {
+  real_t sr, cr, sp, cp, sy, cy;
+
+  real_sincos(roll, &sr, &cr);
+  real_sincos(pitch, &sp, &cp);
+  real_sincos(yaw, &sy, &cy);
+
+  res->m[0][0] = cp * cy;
+  res->m[0][1] = sr * sp * cy - cr * sy;
+  res->m[0][2] = cr * sp * cy + sr * sy;
+  res->m[1][0] = cp * sy;
+  res->m[1][1] = sr * sp * sy + cr * cy;
+  res->m[1][2] = sp * sy * cr - cy * sr;
+  res->m[2][0] = -sp;
+  res->m[2][1] = cp * sr;
+  res->m[2][2] = cp * cr;
+}
+
+void mat3d_from_quat(const quat_t *q, mat3d_t *res) {
+  real_t w = q->w, x = q->x, y = q->y, z = q->z;
+
+  res->m[0][0] = 1 - 2 * (y * y + z * z);
+  res->m[0][1] = 2 * (x * y - w * z);
+  res->m[0][2] = 2 * (x * z + w * y);
+  res->m[1][0] = 2 * (x * y + w * z);
+  res->m[1][1] = 1 - 2 * (x * x + z * z);
+  res->m[1][2] = 2 * (y * z - w * x);
+  res->m[2][0] = 2 * (x * z - w * y);
+  res->m[2][1] = 2 * (y * z + w * x);
+  res->m[2][2] = 1 - 2 * (x * x + y * y);
+}
+
+void mat3d_mul(const mat3d_t *a, const mat3d_t *b, mat3d_t *res) {
+  mat3d_t p;
+
+  for (unsigned i = 0; i < 3; i++) {
+    for (unsigned j = 0; j < 3; j++) {
+      p.m[i][j] = a->m[i][0] * b->m[0][j] + a->m[i][1] * b->m[1][j] +
+                  a->m[i][2] * b->m[2][j];
+    }
+  }
+
+  *res = p;
+}
+
+void mat3d_transpose(const mat3d_t *m, mat3d_t *res) {
+  mat3d_t t;
+
+  for (unsigned i = 0; i < 3; i++) {
+    for (unsigned j = 0; j < 3; j++) {
+      t.m[i][j] = m->m[j][i];
+    }
+  }
+
+  *res = t;
+}
+
+vec3d_t mat3d_apply_r(const mat3d_t *m, const vec3d_t *v) {
+  vec3d_t res;
+  mat3d_apply(m, v, &res);
+  return res;
+}
+
+void quat_from_euler(real_t roll, real_t pitch, real_t yaw, quat_t *res) {
+  real_t sr, cr, sp, cp, sy, cy;
+
+  real_sincos(roll / 2, &sr, &cr);
+  real_sincos(pitch / 2, &sp, &cp);
+  real_sincos(yaw / 2, &sy, &cy);
+
+  res->w = cr * cp * cy + sr * sp * sy;
+  res->x = sr * cp * cy - cr * sp * sy;
+  res->y = cr * sp * cy + sr * cp * sy;
+  res->z = cr * cp * sy - sr * sp * cy;
+}
+
+void quat_to_euler(const quat_t *q, vec3d_t *res) {
+  real_t w = q->w, x = q->x, y = q->y, z = q->z;
+
+  /* Rounding may push the sine of the pitch slightly past 1 near the poles */
+
+  real_t sp = 2 * (w * y - z * x);
+  sp = sp > 1 ? 1 : sp < -1 ? -1 : sp;
+
+  res->x = real_atan2(2 * (w * x + y * z), 1 - 2 * (x * x + y * y));
+  res->y = real_asin(sp);
+  res->z = real_atan2(2 * (w * z + x * y), 1 - 2 * (y * y + z * z));
+}
+
+void quat_mul(const quat_t *a, const quat_t *b, quat_t *res) {
+  quat_t p;
+
+  p.w = a->w * b->w - a->x * b->x - a->y * b->y - a->z * b->z;
+  p.x = a->w * b->x + a->x * b->w + a->y * b->z - a->z * b->y;
+  p.y = a->w * b->y - a->x * b->z + a->y * b->w + a->z * b->x;
+  p.z = a->w * b->z + a->x * b->y - a->y * b->x + a->z * b->w;
+  *res = p;
+}
+
+void quat_normalize(quat_t *q) {
+  real_t norm =
+      real_sqrt(q->w * q->w + q->x * q->x + q->y * q->y + q->z * q->z);
+  if (norm <= 0) return;
+
+  q->w /= norm;
+  q->x /= norm;
+  q->y /= norm;
+  q->z /= norm;
+}
+
+/* With u the vector part of q: v' = v + w * t + u x t, where t = 2 * u x v */
+
+void quat_apply(const quat_t *q, const vec3d_t *v, vec3d_t *res) {
+  vec3d_t u = *v;
+  real_t tx = 2 * (q->y * u.z - q->z * u.y);
+  real_t ty = 2 * (q->z * u.x - q->x * u.z);
+  real_t tz = 2 * (q->x * u.y - q->y * u.x);
+
+  res->x = u.x + q->w * tx + (q->y * tz - q->z * ty);
+  res->y = u.y + q->w * ty + (q->z * tx - q->x * tz);
+  res->z = u.z + q->w * tz + (q->x * ty - q->y * tx);
+}
+
+vec3d_t quat_apply_r(const quat_t *q, const vec3d_t *v) {
+  vec3d_t res;
+  quat_apply(q, v, &res);
+  return res;
+}
+
+/* The rotation over the step is about the axis of the angular velocity, by its
+ * norm times dt, and is applied in the body's frame, i.e. after q.
+ */
+
+void quat_integrate(quat_t *q, const vec3d_t *angvel, real_t dt) {
+  real_t rate = vec3d_norm_r((vec3d_t *)angvel);
+  if (rate <= 0) return;
+
+  real_t s, c;
+  real_sincos(rate * dt / 2, &s, &c);
+
+  real_t k = s / rate;
+  quat_t dq = {c, angvel->x * k, angvel->y * k, angvel->z * k};
+  quat_mul(q, &dq, q);
+  quat_normalize(q);
+}
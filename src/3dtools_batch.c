@@ -0,0 +1,342 @@
+/* Included files */
+
+#include <string.h>
+
+#include "3dtools.h"
+#include "simd.h"
+#include "trig.h"
+#include "utils.h"
+
+const char *vec_batch_isa(void) { return SIMD_ISA; }
+
+/* Axes
+ *
+ * Element-wise operations are done one axis at a time: with every axis in the
+ * same loop, the compiler would have to check too many pairs of arrays for
+ * overlap at run-time, and gives up vectorizing.
+ */
+
+SIMD_INLINE void axis_add_k(const real_t *a, const real_t *b, real_t *res,
+                            size_t n) {
+  for (size_t k = 0; k < n; k++) {
+    res[k] = a[k] + b[k];
+  }
+}
+
+SIMD_INLINE void axis_scale_k(const real_t *a, real_t alpha, real_t *res,
+                              size_t n) {
+  for (size_t k = 0; k < n; k++) {
+    res[k] = alpha * a[k];
+  }
+}
+
+SIMD_INLINE void axis_project_k(const real_t *a, const real_t *z,
+                                real_t camdist, real_t *res, size_t n) {
+  for (size_t k = 0; k < n; k++) {
+    res[k] = a[k] / (z[k] / camdist);
+  }
+}
+
+/* Vectors in 2 dimensions
+ *
+ * The arrays are loaded into locals first, so the compiler doesn't have to
+ * assume that storing a result changes where the arrays are.
+ */
+
+SIMD_INLINE void vec2d_batch_add_k(const vec2d_batch_t *v1,
+                                   const vec2d_batch_t *v2, vec2d_batch_t *res,
+                                   size_t n) {
+  axis_add_k(v1->x, v2->x, res->x, n);
+  axis_add_k(v1->y, v2->y, res->y, n);
+}
+
+SIMD_KERNEL(vec2d_batch_add,
+            (const vec2d_batch_t *v1, const vec2d_batch_t *v2,
+             vec2d_batch_t *res, size_t n),
+            (v1, v2, res, n))
+
+SIMD_INLINE void vec2d_batch_scale_k(const vec2d_batch_t *v, real_t alpha,
+                                     vec2d_batch_t *res, size_t n) {
+  axis_scale_k(v->x, alpha, res->x, n);
+  axis_scale_k(v->y, alpha, res->y, n);
+}
+
+SIMD_KERNEL(vec2d_batch_scale,
+            (const vec2d_batch_t *v, real_t alpha, vec2d_batch_t *res,
+             size_t n),
+            (v, alpha, res, n))
+
+SIMD_INLINE void vec2d_batch_dot_k(const vec2d_batch_t *v1,
+                                   const vec2d_batch_t *v2, real_t *res,
+                                   size_t n) {
+  const real_t *x1 = v1->x, *y1 = v1->y;
+  const real_t *x2 = v2->x, *y2 = v2->y;
+
+  for (size_t k = 0; k < n; k++) {
+    res[k] = x1[k] * x2[k] + y1[k] * y2[k];
+  }
+}
+
+SIMD_KERNEL(vec2d_batch_dot,
+            (const vec2d_batch_t *v1, const vec2d_batch_t *v2, real_t *res,
+             size_t n),
+            (v1, v2, res, n))
+
+SIMD_INLINE void vec2d_batch_norm_k(const vec2d_batch_t *v, real_t *res,
+                                    size_t n) {
+  const real_t *x = v->x, *y = v->y;
+
+  for (size_t k = 0; k < n; k++) {
+    res[k] = real_sqrt(x[k] * x[k] + y[k] * y[k]);
+  }
+}
+
+SIMD_KERNEL(vec2d_batch_norm, (const vec2d_batch_t *v, real_t *res, size_t n),
+            (v, res, n))
+
+SIMD_INLINE void vec2d_batch_dist_k(const vec2d_batch_t *v1,
+                                    const vec2d_batch_t *v2, real_t *res,
+                                    size_t n) {
+  const real_t *x1 = v1->x, *y1 = v1->y;
+  const real_t *x2 = v2->x, *y2 = v2->y;
+
+  for (size_t k = 0; k < n; k++) {
+    real_t dx = x1[k] - x2[k];
+    real_t dy = y1[k] - y2[k];
+    res[k] = real_sqrt(dx * dx + dy * dy);
+  }
+}
+
+SIMD_KERNEL(vec2d_batch_dist,
+            (const vec2d_batch_t *v1, const vec2d_batch_t *v2, real_t *res,
+             size_t n),
+            (v1, v2, res, n))
+
+/* The rows are vectorized, since they are usually the longer loop */
+
+SIMD_INLINE void vec2d_batch_dist_pairwise_k(const vec2d_batch_t *v1,
+                                             size_t n1, const vec2d_batch_t *v2,
+                                             size_t n2, real_t *res) {
+  const real_t *x2 = v2->x, *y2 = v2->y;
+
+  for (size_t i = 0; i < n1; i++) {
+    real_t x1 = v1->x[i];
+    real_t y1 = v1->y[i];
+    real_t *row = &res[i * n2];
+
+    for (size_t j = 0; j < n2; j++) {
+      real_t dx = x1 - x2[j];
+      real_t dy = y1 - y2[j];
+      row[j] = real_sqrt(dx * dx + dy * dy);
+    }
+  }
+}
+
+SIMD_KERNEL(vec2d_batch_dist_pairwise,
+            (const vec2d_batch_t *v1, size_t n1, const vec2d_batch_t *v2,
+             size_t n2, real_t *res),
+            (v1, n1, v2, n2, res))
+
+/* Vectors in 3 dimensions */
+
+SIMD_INLINE void vec3d_batch_add_k(const vec3d_batch_t *v1,
+                                   const vec3d_batch_t *v2, vec3d_batch_t *res,
+                                   size_t n) {
+  axis_add_k(v1->x, v2->x, res->x, n);
+  axis_add_k(v1->y, v2->y, res->y, n);
+  axis_add_k(v1->z, v2->z, res->z, n);
+}
+
+SIMD_KERNEL(vec3d_batch_add,
+            (const vec3d_batch_t *v1, const vec3d_batch_t *v2,
+             vec3d_batch_t *res, size_t n),
+            (v1, v2, res, n))
+
+SIMD_INLINE void vec3d_batch_scale_k(const vec3d_batch_t *v, real_t alpha,
+                                     vec3d_batch_t *res, size_t n) {
+  axis_scale_k(v->x, alpha, res->x, n);
+  axis_scale_k(v->y, alpha, res->y, n);
+  axis_scale_k(v->z, alpha, res->z, n);
+}
+
+SIMD_KERNEL(vec3d_batch_scale,
+            (const vec3d_batch_t *v, real_t alpha, vec3d_batch_t *res,
+             size_t n),
+            (v, alpha, res, n))
+
+SIMD_INLINE void vec3d_batch_dot_k(const vec3d_batch_t *v1,
+                                   const vec3d_batch_t *v2, real_t *res,
+                                   size_t n) {
+  const real_t *x1 = v1->x, *y1 = v1->y, *z1 = v1->z;
+  const real_t *x2 = v2->x, *y2 = v2->y, *z2 = v2->z;
+
+  for (size_t k = 0; k < n; k++) {
+    res[k] = x1[k] * x2[k] + y1[k] * y2[k] + z1[k] * z2[k];
+  }
+}
+
+SIMD_KERNEL(vec3d_batch_dot,
+            (const vec3d_batch_t *v1, const vec3d_batch_t *v2, real_t *res,
+             size_t n),
+            (v1, v2, res, n))
+
+SIMD_INLINE void vec3d_batch_norm_k(const vec3d_batch_t *v, real_t *res,
+                                    size_t n) {
+  const real_t *x = v->x, *y = v->y, *z = v->z;
+
+  for (size_t k = 0; k < n; k++) {
+    res[k] = real_sqrt((x[k] * x[k]) + (y[k] * y[k]) + (z[k] * z[k]));
+  }
+}
+
+SIMD_KERNEL(vec3d_batch_norm, (const vec3d_batch_t *v, real_t *res, size_t n),
+            (v, res, n))
+
+SIMD_INLINE void vec3d_batch_dist_k(const vec3d_batch_t *v1,
+                                    const vec3d_batch_t *v2, real_t *res,
+                                    size_t n) {
+  const real_t *x1 = v1->x, *y1 = v1->y, *z1 = v1->z;
+  const real_t *x2 = v2->x, *y2 = v2->y, *z2 = v2->z;
+
+  for (size_t k = 0; k < n; k++) {
+    real_t dx = x1[k] - x2[k];
+    real_t dy = y1[k] - y2[k];
+    real_t dz = z1[k] - z2[k];
+    res[k] = real_sqrt((dx * dx) + (dy * dy) + (dz * dz));
+  }
+}
+
+SIMD_KERNEL(vec3d_batch_dist,
+            (const vec3d_batch_t *v1, const vec3d_batch_t *v2, real_t *res,
+             size_t n),
+            (v1, v2, res, n))
+
+SIMD_INLINE void vec3d_batch_dist_pairwise_k(const vec3d_batch_t *v1,
+                                             size_t n1, const vec3d_batch_t *v2,
+                                             size_t n2, real_t *res) {
+  const real_t *x2 = v2->x, *y2 = v2->y, *z2 = v2->z;
+
+  for (size_t i = 0; i < n1; i++) {
+    real_t x1 = v1->x[i];
+    real_t y1 = v1->y[i];
+    real_t z1 = v1->z[i];
+    real_t *row = &res[i * n2];
+
+    for (size_t j = 0; j < n2; j++) {
+      real_t dx = x1 - x2[j];
+      real_t dy = y1 - y2[j];
+      real_t dz = z1 - z2[j];
+      row[j] = real_sqrt((dx * dx) + (dy * dy) + (dz * dz));
+    }
+  }
+}
+
+SIMD_KERNEL(vec3d_batch_dist_pairwise,
+            (const vec3d_batch_t *v1, size_t n1, const vec3d_batch_t *v2,
+             size_t n2, real_t *res),
+            (v1, n1, v2, n2, res))
+
+/* The sine and cosine are computed once for the whole batch. The axis which
+ * doesn't change is copied, unless the rotation is in place.
+ */
+
+SIMD_INLINE void vec3d_batch_rotate_k(const vec3d_batch_t *v, real_t angle,
+                                      enum axis_e axis, vec3d_batch_t *res,
+                                      size_t n) {
+  const real_t *x = v->x, *y = v->y, *z = v->z;
+  real_t *rx = res->x, *ry = res->y, *rz = res->z;
+  real_t s, c;
+
+  real_sincos(angle, &s, &c);
+
+  switch (axis) {
+  case AXIS_X:
+    for (size_t k = 0; k < n; k++) {
+      real_t vy = y[k];
+      real_t vz = z[k];
+      ry[k] = vy * c - vz * s;
+      rz[k] = vy * s + vz * c;
+    }
+    if (rx != x) memcpy(rx, x, sizeof(real_t) * n);
+    break;
+  case AXIS_Y:
+    for (size_t k = 0; k < n; k++) {
+      real_t vx = x[k];
+      real_t vz = z[k];
+      rx[k] = vx * c + vz * s;
+      rz[k] = vx * -s + vz * c;
+    }
+    if (ry != y) memcpy(ry, y, sizeof(real_t) * n);
+    break;
+  case AXIS_Z:
+    for (size_t k = 0; k < n; k++) {
+      real_t vx = x[k];
+      real_t vy = y[k];
+      rx[k] = vx * c - vy * s;
+      ry[k] = vx * s + vy * c;
+    }
+    if (rz != z) memcpy(rz, z, sizeof(real_t) * n);
+    break;
+  default:
+    unreachable("No such axis.");
+    break;
+  }
+}
+
+SIMD_KERNEL(vec3d_batch_rotate,
+            (const vec3d_batch_t *v, real_t angle, enum axis_e axis,
+             vec3d_batch_t *res, size_t n),
+            (v, angle, axis, res, n))
+
+SIMD_INLINE void vec3d_batch_project_k(const vec3d_batch_t *v, real_t camdist,
+                                       vec2d_batch_t *res, size_t n) {
+  axis_project_k(v->x, v->z, camdist, res->x, n);
+  axis_project_k(v->y, v->z, camdist, res->y, n);
+}
+
+SIMD_KERNEL(vec3d_batch_project,
+            (const vec3d_batch_t *v, real_t camdist, vec2d_batch_t *res,
+             size_t n),
+            (v, camdist, res, n))
+
+/* Rotations
+ *
+ * Each axis of the result depends on every axis of the vectors, so the results
+ * are computed into blocks on the stack, one axis at a time, and copied out
+ * afterwards. This allows rotating in place, and the loops only access arrays
+ * which the compiler knows can't overlap.
+ */
+
+#define ROTATE_BLOCK (64) /* Vectors per block */
+
+SIMD_INLINE void axis_apply_k(const real_t *row, const real_t *x,
+                              const real_t *y, const real_t *z, real_t *res,
+                              size_t n) {
+  for (size_t k = 0; k < n; k++) {
+    res[k] = row[0] * x[k] + row[1] * y[k] + row[2] * z[k];
+  }
+}
+
+SIMD_INLINE void mat3d_batch_apply_k(const mat3d_t *m, const vec3d_batch_t *v,
+                                     vec3d_batch_t *res, size_t n) {
+  real_t bx[ROTATE_BLOCK];
+  real_t by[ROTATE_BLOCK];
+  real_t bz[ROTATE_BLOCK];
+
+  for (size_t k = 0; k < n; k += ROTATE_BLOCK) {
+    size_t len = n - k < ROTATE_BLOCK ? n - k : ROTATE_BLOCK;
+    const real_t *x = &v->x[k], *y = &v->y[k], *z = &v->z[k];
+
+    axis_apply_k(m->m[0], x, y, z, bx, len);
+    axis_apply_k(m->m[1], x, y, z, by, len);
+    axis_apply_k(m->m[2], x, y, z, bz, len);
+    memcpy(&res->x[k], bx, sizeof(real_t) * len);
+    memcpy(&res->y[k], by, sizeof(real_t) * len);
+    memcpy(&res->z[k], bz, sizeof(real_t) * len);
+  }
+}
+
+SIMD_KERNEL(mat3d_batch_apply,
+            (const mat3d_t *m, const vec3d_batch_t *v, vec3d_batch_t *res,
+             size_t n),
+            (m, v, res, n))
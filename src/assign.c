@@ -0,0 +1,326 @@
+/* Included files */
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "assign.h"
+
+bool assign_init(assign_t *a, size_t n) {
+  a->n = n;
+  a->row_col = malloc(sizeof(size_t) * n);
+  a->last = malloc(sizeof(size_t) * n);
+  a->col_row = malloc(sizeof(size_t) * (n + 1));
+  a->way = malloc(sizeof(size_t) * (n + 1));
+  a->u = malloc(sizeof(double) * (n + 1));
+  a->v = malloc(sizeof(double) * (n + 1));
+  a->minv = malloc(sizeof(double) * (n + 1));
+  a->used = malloc(sizeof(bool) * (n + 1));
+
+  a->solved = false;
+
+  if (a->row_col == NULL || a->last == NULL || a->col_row == NULL ||
+      a->way == NULL || a->u == NULL || a->v == NULL || a->minv == NULL ||
+      a->used == NULL) {
+    assign_free(a);
+    return false;
+  }
+
+  return true;
+}
+
+void assign_free(assign_t *a) {
+  free(a->row_col);
+  free(a->last);
+  free(a->col_row);
+  free(a->way);
+  free(a->u);
+  free(a->v);
+  free(a->minv);
+  free(a->used);
+  a->row_col = NULL;
+  a->last = NULL;
+  a->col_row = NULL;
+  a->way = NULL;
+  a->u = NULL;
+  a->v = NULL;
+  a->minv = NULL;
+  a->used = NULL;
+}
+
+/* Matches row i, which is free, by the shortest augmenting path. The
+ * potentials must be feasible (u[i] + v[j] <= cost of i and j) and tight on
+ * the matched pairs, and stay so.
+ */
+static void augment(assign_t *a, const real_t *cost, double sign, size_t i) {
+  size_t n = a->n;
+  size_t *p = a->col_row;
+  size_t *way = a->way;
+  double *u = a->u;
+  double *v = a->v;
+  double *minv = a->minv;
+  bool *used = a->used;
+
+  /* Grow a tree of tight edges from row i, through the columns, until it
+   * reaches a free column. Every column left out of the tree has its smallest
+   * reduced cost from the tree in minv, and the potentials move by the
+   * smallest of them, which brings one more column into the tree.
+   */
+
+  size_t j0 = 0;
+  p[0] = i;
+  for (size_t j = 0; j <= n; j++) {
+    minv[j] = INFINITY;
+    used[j] = false;
+  }
+
+  do {
+    size_t i0 = p[j0];
+    const real_t *row = &cost[(i0 - 1) * n];
+    double delta = INFINITY;
+    size_t j1 = 0;
+
+    used[j0] = true;
+    for (size_t j = 1; j <= n; j++) {
+      if (used[j]) continue;
+      double cur = sign * row[j - 1] - u[i0] - v[j];
+      if (cur < minv[j]) {
+        minv[j] = cur;
+        way[j] = j0;
+      }
+      if (minv[j] < delta) {
+        delta = minv[j];
+        j1 = j;
+      }
+    }
+
+    for (size_t j = 0; j <= n; j++) {
+      if (used[j]) {
+        u[p[j]] += delta;
+        v[j] -= delta;
+      } else {
+        minv[j] -= delta;
+      }
+    }
+    j0 = j1;
+  } while (p[j0] != 0);
+
+  /* Flip the assignments along the path back to row i */
+
+  do {
+    size_t j1 = way[j0];
+    p[j0] = p[j1];
+    j0 = j1;
+  } while (j0 != 0);
+}
+
+/* Matches the rows left free, marked by column n in `row_col`, then writes the
+ * solution to `row_col`.
+ */
+static void augment_free(assign_t *a, const real_t *cost, double sign) {
+  size_t n = a->n;
+  size_t *p = a->col_row;
+
+  for (size_t i = 1; i <= n; i++) {
+    if (a->row_col[i - 1] == n) augment(a, cost, sign, i);
+  }
+
+  for (size_t j = 1; j <= n; j++) a->row_col[p[j] - 1] = j - 1;
+  a->solved = true;
+}
+
+double assign_solve(assign_t *a, const real_t *cost, bool maximize) {
+  size_t n = a->n;
+  double sign = maximize ? -1.0 : 1.0;
+  size_t *p = a->col_row;
+
+  for (size_t i = 0; i <= n; i++) {
+    a->u[i] = 0.0;
+    a->v[i] = 0.0;
+    p[i] = 0;
+  }
+  for (size_t i = 0; i < n; i++) a->row_col[i] = n;
+
+  /* Start from the smallest cost of every column as its potential, and match
+   * the columns whose smallest cost is in a free row right away: they are
+   * tight. Only the other rows need augmenting paths.
+   */
+
+  for (size_t j = 1; j <= n; j++) {
+    size_t imin = 1;
+    for (size_t i = 2; i <= n; i++) {
+      if (sign * cost[(i - 1) * n + j - 1] <
+          sign * cost[(imin - 1) * n + j - 1]) {
+        imin = i;
+      }
+    }
+    a->v[j] = sign * cost[(imin - 1) * n + j - 1];
+    if (a->row_col[imin - 1] == n) {
+      p[j] = imin;
+      a->row_col[imin - 1] = j - 1;
+    }
+  }
+
+  augment_free(a, cost, sign);
+
+  double total = 0.0;
+  for (size_t i = 0; i < n; i++) total += cost[i * n + a->row_col[i]];
+  return total;
+}
+
+size_t assign_update(assign_t *a, const real_t *cost, bool maximize) {
+  size_t n = a->n;
+  double sign = maximize ? -1.0 : 1.0;
+  size_t *p = a->col_row;
+  double *v = a->v;
+
+  if (!a->solved) {
+    assign_solve(a, cost, maximize);
+    return n;
+  }
+
+  /* Augmenting only ever lowers the column potentials, so they are shifted
+   * back to a largest potential of 0 to keep their precision.
+   */
+
+  double vmax = -INFINITY;
+  for (size_t j = 1; j <= n; j++) vmax = v[j] > vmax ? v[j] : vmax;
+  for (size_t j = 1; j <= n; j++) v[j] -= vmax;
+
+  /* Any column potentials are feasible with the smallest reduced cost of every
+   * row as its potential. A row keeps its column if it's still one with the
+   * smallest reduced cost, since the pair is then tight, and is freed
+   * otherwise.
+   */
+
+  for (size_t i = 1; i <= n; i++) {
+    const real_t *row = &cost[(i - 1) * n];
+    size_t j0 = a->row_col[i - 1] + 1;
+    double umin = sign * row[j0 - 1] - v[j0];
+    bool keep = true;
+
+    for (size_t j = 1; j <= n; j++) {
+      double cur = sign * row[j - 1] - v[j];
+      if (cur < umin) {
+        umin = cur;
+        keep = false;
+      }
+    }
+
+    a->u[i] = umin;
+    a->last[i - 1] = j0 - 1;
+    if (!keep) {
+      p[j0] = 0;
+      a->row_col[i - 1] = n;
+    }
+  }
+
+  augment_free(a, cost, sign);
+
+  size_t switched = 0;
+  for (size_t i = 0; i < n; i++) switched += a->row_col[i] != a->last[i];
+  return switched;
+}
+
+double assign_search(assign_t *a, const real_t *cost, bool maximize) {
+  size_t n = a->n;
+  double sign = maximize ? -1.0 : 1.0;
+  size_t *next = a->way; /* Next column to try in each row of the branch */
+  double *sum = a->u;    /* Cost of the rows above each row in the branch */
+  double *bound = a->v;  /* Smallest cost of each row and the rows below */
+  bool *used = a->used;  /* Columns taken by the rows above */
+  double best = INFINITY;
+
+  bound[n] = 0.0;
+  for (size_t i = n; i-- > 0;) {
+    const real_t *row = &cost[i * n];
+    double rmin = INFINITY;
+    for (size_t j = 0; j < n; j++) {
+      rmin = sign * row[j] < rmin ? sign * row[j] : rmin;
+    }
+    bound[i] = rmin + bound[i + 1];
+  }
+
+  for (size_t j = 0; j < n; j++) used[j] = false;
+  sum[0] = 0.0;
+  next[0] = 0;
+  size_t i = 0;
+
+  /* Depth-first over the rows: each row takes the next free column which may
+   * still lead to a better assignment, and the search backtracks to the row
+   * above when there is none left.
+   */
+
+  while (true) {
+    const real_t *row = &cost[i * n];
+    size_t j = next[i];
+    while (j < n &&
+           (used[j] || sum[i] + sign * row[j] + bound[i + 1] >= best)) {
+      j++;
+    }
+
+    if (j == n) {
+      if (i == 0) break;
+      i--;
+      used[next[i] - 1] = false;
+      continue;
+    }
+
+    next[i] = j + 1;
+    sum[i + 1] = sum[i] + sign * row[j];
+    if (i + 1 == n) {
+      best = sum[n];
+      for (size_t k = 0; k < n; k++) a->row_col[k] = next[k] - 1;
+      continue;
+    }
+
+    used[j] = true;
+    i++;
+    next[i] = 0;
+  }
+
+  a->solved = false;
+  return sign * best;
+}
+
+void assign_copy(assign_t *dst, const assign_t *src) {
+  size_t n = src->n;
+  memcpy(dst->row_col, src->row_col, sizeof(size_t) * n);
+  memcpy(dst->col_row, src->col_row, sizeof(size_t) * (n + 1));
+  memcpy(dst->u, src->u, sizeof(double) * (n + 1));
+  memcpy(dst->v, src->v, sizeof(double) * (n + 1));
+  dst->solved = src->solved;
+}
+
+size_t assign_save(const assign_t *a, void *buf) {
+  size_t n = a->n;
+  size_t size = sizeof(size_t) * (2 * n + 1) + sizeof(double) * 2 * (n + 1) +
+                sizeof(bool);
+  if (buf == NULL) return size;
+
+  unsigned char *b = buf;
+  memcpy(b, a->row_col, sizeof(size_t) * n);
+  b += sizeof(size_t) * n;
+  memcpy(b, a->col_row, sizeof(size_t) * (n + 1));
+  b += sizeof(size_t) * (n + 1);
+  memcpy(b, a->u, sizeof(double) * (n + 1));
+  b += sizeof(double) * (n + 1);
+  memcpy(b, a->v, sizeof(double) * (n + 1));
+  b += sizeof(double) * (n + 1);
+  memcpy(b, &a->solved, sizeof(bool));
+  return size;
+}
+
+void assign_restore(assign_t *a, const void *buf) {
+  size_t n = a->n;
+  const unsigned char *b = buf;
+  memcpy(a->row_col, b, sizeof(size_t) * n);
+  b += sizeof(size_t) * n;
+  memcpy(a->col_row, b, sizeof(size_t) * (n + 1));
+  b += sizeof(size_t) * (n + 1);
+  memcpy(a->u, b, sizeof(double) * (n + 1));
+  b += sizeof(double) * (n + 1);
+  memcpy(a->v, b, sizeof(double) * (n + 1));
+  b += sizeof(double) * (n + 1);
+  memcpy(&a->solved, b, sizeof(bool));
+}
@@ -1,8 +1,53 @@
 /* Included files */
 
 #include <assert.h>
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
 
 #include "dynsys.h"
+#include "dynsys_stepper.h"
+#include "recorder.h"
+#include "utils.h"
+
+/* Step size controller of the adaptive method */
+
+#define DOPRI_SAFETY (0.9)   /* Fraction of the optimal step size to aim for */
+#define DOPRI_FAC_MIN (0.2)  /* Most a step can shrink by at once */
+#define DOPRI_FAC_MAX (5.0)  /* Most a step can grow by at once */
+#define DOPRI_STRETCH (1.01) /* Most a step is stretched to meet a deadline */
+
+/* Dormand-Prince tableau. The last stage is evaluated at the 5th order
+ * solution, so its row holds the solution weights.
+ */
+
+#define DOPRI_STAGES DYNSYS_DOPRI_STAGES
+
+static const double dopri_a[DOPRI_STAGES][DOPRI_STAGES - 1] = {
+    {0.0},
+    {1.0 / 5},
+    {3.0 / 40, 9.0 / 40},
+    {44.0 / 45, -56.0 / 15, 32.0 / 9},
+    {19372.0 / 6561, -25360.0 / 2187, 64448.0 / 6561, -212.0 / 729},
+    {9017.0 / 3168, -355.0 / 33, 46732.0 / 5247, 49.0 / 176,
+     -5103.0 / 18656},
+    {35.0 / 384, 0.0, 500.0 / 1113, 125.0 / 192, -2187.0 / 6784, 11.0 / 84},
+};
+
+/* Difference between the 5th and the embedded 4th order weights */
+
+static const double dopri_e[DOPRI_STAGES] = {
+    71.0 / 57600,      0.0,        -71.0 / 16695, 71.0 / 1920,
+    -17253.0 / 339200, 22.0 / 525, -1.0 / 40,
+};
+
+static const dynsys_tol_t dynsys_tol_default = {
+    .rtol = DYNSYS_RTOL,
+    .atol = DYNSYS_ATOL,
+    .h_min = DYNSYS_H_MIN,
+    .h_max = DYNSYS_H_MAX,
+};
 
 void dynsys_init(dynsys_t *s, void *x, dynamics_f f, control_f u, run_cost_f g,
                  term_cost_f q) {
@@ -14,16 +59,464 @@ void dynsys_init(dynsys_t *s, void *x, dynamics_f f, control_f u, run_cost_f g,
   s->u = u;
   s->g = g;
   s->q = q;
+  s->d = NULL;
+  s->v = NULL;
+  s->n = 0;
+  s->method = INTEGRATOR_EULER;
+  s->work = NULL;
+  s->tol = dynsys_tol_default;
+  memset(&s->stats, 0, sizeof(s->stats));
+  s->h = 0.0;
+  s->e = NULL;
+  s->er = NULL;
+  s->e_tol = DYNSYS_EVENT_TOL;
+  s->event = false;
+  s->rec = NULL;
+  s->size = 0;
+  s->copy = NULL;
+  s->save = NULL;
+  s->restore = NULL;
+  s->ut = NULL;
+  s->gt = NULL;
+  s->t = 0.0;
+  s->ctx = NULL;
+  s->u_period = 0.0;
+  s->u_next = 0.0;
+  s->u_last = 0.0;
+  s->step = NULL;
+  dynsys_prof_reset(s);
 }
 
-void dynsys_step(dynsys_t *s, double dt) {
-  assert(s->f != NULL);
-  if (s->g != NULL) s->c += s->g(s->x, dt); /* Update running cost */
-  s->f(s->x, dt); /* Apply system dynamics to initial state */
-  if (s->u != NULL) s->u(s->x, dt); /* Update control variables */
+bool dynsys_init_ode(dynsys_t *s, void *x, real_t *v, size_t n, deriv_f d,
+                     enum integrator_e method, control_f u, run_cost_f g,
+                     term_cost_f q) {
+  assert(s != NULL);
+  assert(d != NULL);
+  assert(v != NULL || n == 0);
+  s->work = malloc(sizeof(real_t) * DYNSYS_WORK_SIZE(n));
+  if (s->work == NULL) return false;
+  s->c = 0.0; /* No cost at start of game */
+  s->x = x;
+  s->f = NULL;
+  s->u = u;
+  s->g = g;
+  s->q = q;
+  s->d = d;
+  s->v = v;
+  s->n = n;
+  s->method = method;
+  s->tol = dynsys_tol_default;
+  memset(&s->stats, 0, sizeof(s->stats));
+  s->h = 0.0;
+  s->e = NULL;
+  s->er = NULL;
+  s->e_tol = DYNSYS_EVENT_TOL;
+  s->event = false;
+  s->rec = NULL;
+  s->size = 0;
+  s->copy = NULL;
+  s->save = NULL;
+  s->restore = NULL;
+  s->ut = NULL;
+  s->gt = NULL;
+  s->t = 0.0;
+  s->ctx = NULL;
+  s->u_period = 0.0;
+  s->u_next = 0.0;
+  s->u_last = 0.0;
+  s->step = NULL;
+  dynsys_prof_reset(s);
+  return true;
+}
+
+void dynsys_set_integrator(dynsys_t *s, enum integrator_e method) {
+  assert(s->d != NULL);
+  s->method = method;
+}
+
+void dynsys_set_tolerance(dynsys_t *s, const dynsys_tol_t *tol) {
+  assert(tol->rtol >= 0.0 && tol->atol >= 0.0);
+  assert(tol->rtol > 0.0 || tol->atol > 0.0);
+  assert(tol->h_min > 0.0 && tol->h_min <= tol->h_max);
+  s->tol = *tol;
+}
+
+void dynsys_set_event(dynsys_t *s, event_f e, double tol) {
+  assert(tol > 0.0);
+  s->e = e;
+  s->e_tol = tol;
+  s->event = false;
+}
+
+void dynsys_set_event_rate(dynsys_t *s, event_rate_f rate) { s->er = rate; }
+
+void dynsys_set_recorder(dynsys_t *s, struct recorder *rec) {
+  assert(rec == NULL || s->d != NULL);
+  s->rec = rec;
+  if (rec != NULL) recorder_append(rec, 0.0, s->v);
+}
+
+void dynsys_set_control(dynsys_t *s, control_tf u, run_cost_tf g, void *ctx) {
+  s->u = NULL;
+  s->g = NULL;
+  s->ut = u;
+  s->gt = g;
+  s->ctx = ctx;
+}
+
+void dynsys_set_control_period(dynsys_t *s, double period) {
+  assert(period >= 0.0);
+  s->u_period = period;
+  s->u_next = s->t;
+  s->u_last = s->t;
+}
+
+void dynsys_set_stepper(dynsys_t *s, dynsys_step_f step) {
+  assert(step == NULL || s->d != NULL);
+  s->step = step;
+}
+
+void dynsys_set_state(dynsys_t *s, size_t size, state_copy_f copy,
+                      state_save_f save, state_restore_f restore) {
+  assert((save == NULL) == (restore == NULL));
+  s->size = size;
+  s->copy = copy;
+  s->save = save;
+  s->restore = restore;
+}
+
+void dynsys_free(dynsys_t *s) {
+  free(s->work);
+  s->work = NULL;
+}
+
+/* Attempts a Dormand-Prince step of size h from the saved state. Leaves the
+ * 5th order solution in the state and returns the scaled RMS norm of its error
+ * estimate.
+ */
+double dynsys_dopri_attempt(dynsys_t *s, double h) {
+  real_t *x = s->v;
+  size_t n = s->n;
+  real_t *x0 = s->work;
+  real_t *k = x0 + n; /* Stage j of variable i is k[j * n + i] */
+  double err = 0.0;
+
+  for (size_t j = 1; j < DOPRI_STAGES; j++) {
+    for (size_t i = 0; i < n; i++) {
+      double sum = 0.0;
+      for (size_t l = 0; l < j; l++) {
+        sum += dopri_a[j][l] * k[l * n + i];
+      }
+      x[i] = x0[i] + h * sum;
+    }
+    dynsys_deriv(s, s->d, &k[j * n]);
+  }
+  s->stats.evals += DOPRI_STAGES - 1;
+
+  for (size_t i = 0; i < n; i++) {
+    double e = 0.0;
+    for (size_t l = 0; l < DOPRI_STAGES; l++) {
+      e += dopri_e[l] * k[l * n + i];
+    }
+    e *= h / (s->tol.atol + s->tol.rtol * fmax(fabs(x0[i]), fabs(x[i])));
+    err += e * e;
+  }
+
+  return n > 0 ? sqrt(err / n) : 0.0;
+}
+
+/* Takes a single error controlled step of at most dt_max and returns its size.
+ * A step which is shortened to end at dt_max may only shrink the next one.
+ */
+double dynsys_dopri_step(dynsys_t *s, double dt_max) {
+  assert(dt_max > 0.0);
+  double fac_max = DOPRI_FAC_MAX;
+  double h = s->h > 0.0 ? s->h : s->tol.h_max;
+
+  dynsys_ode_save(s, s->d);
+
+  for (;;) {
+
+    /* Steps which would end just short of dt_max are stretched to reach it,
+     * rather than leaving a sliver for the next step.
+     */
+
+    h = fmax(fmin(h, s->tol.h_max), s->tol.h_min);
+    bool clipped = h * DOPRI_STRETCH >= dt_max;
+    if (clipped) h = dt_max;
+
+    double err = dynsys_dopri_attempt(s, h);
+    double fac = err > 0.0 ? DOPRI_SAFETY * pow(err, -0.2) : fac_max;
+    fac = fmin(fac_max, fmax(DOPRI_FAC_MIN, fac));
+
+    if (err <= 1.0 || h <= s->tol.h_min) {
+      s->stats.accepted++;
+      if (!clipped || h * fac < s->h) s->h = h * fac;
+      return h;
+    }
+
+    /* Retry from the saved state, without growing again right away */
+
+    s->stats.rejected++;
+    fac_max = 1.0;
+    h *= fac;
+  }
+}
+
+/* Tallies the running cost over a single step of size h which was just
+ * integrated, by swapping the saved state variables back in.
+ */
+static void ode_run_cost(dynsys_t *s, double h) {
+  real_t *x1 = s->work + (DOPRI_STAGES + 1) * s->n;
+  memcpy(x1, s->v, sizeof(real_t) * s->n);
+  memcpy(s->v, s->work, sizeof(real_t) * s->n);
+  s->c += dynsys_run_cost(s, h, s->gt);
+  memcpy(s->v, x1, sizeof(real_t) * s->n);
+}
+
+double dynsys_step(dynsys_t *s, double dt) {
+  if (s->step != NULL) return s->step(s, dt);
+  return dynsys_step_generic(s, dt);
+}
+
+double dynsys_step_generic(dynsys_t *s, double dt) {
+  assert(s->f != NULL || s->d != NULL);
+  if (s->d != NULL) {
+    return dynsys_step_ode(s, dt, s->method, s->d, s->ut, s->gt, s->e);
+  }
+
+  double cost = 0.0;
+
+  if (s->event) return 0.0; /* Stopped by the terminal event */
+  if (dynsys_has_run_cost(s, s->gt)) cost = dynsys_run_cost(s, dt, s->gt);
+
+  DYNSYS_PROF(s, DYNSYS_FN_F, s->f(s->x, dt)); /* Apply system dynamics */
+  if (s->e != NULL && dynsys_event_value(s, s->e) <= 0.0) s->event = true;
+
+  s->c += cost;
+  s->t += dt;
+  if (!s->event) dynsys_control(s, dt, s->ut); /* Update control variables */
+  if (s->rec != NULL) recorder_append(s->rec, dt, s->v);
+  return dt;
+}
+
+double dynsys_step_adaptive(dynsys_t *s, double dt_max) {
+  assert(s->d != NULL && s->method == INTEGRATOR_RK45);
+  if (s->event) return 0.0; /* Stopped by terminal event */
+
+  /* Steps end at the control updates, so that the controls change at the same
+   * times whatever the step sizes. An update which is already due happens at
+   * the end of this step, and the next one a period later.
+   */
+
+  if (s->u_period > 0.0) {
+    double due = s->u_next > s->t ? s->u_next - s->t : s->u_period;
+    if (due < dt_max) dt_max = due;
+  }
+
+  double h = dynsys_ode_step(s, dt_max, s->method, s->d, s->e);
+  if (dynsys_has_run_cost(s, s->gt)) ode_run_cost(s, h);
+  s->t += h;
+  if (!s->event) dynsys_control(s, h, s->ut); /* Update control variables */
+  if (s->rec != NULL) recorder_append(s->rec, h, s->v);
+  return h;
 }
 
 double dynsys_cost(const dynsys_t *s) {
   if (s->q == NULL) return s->c;
-  return s->c + s->q(s->x);
+
+  double q;
+#if CONFIG_PROFILE
+  dynsys_t *ps = (dynsys_t *)s; /* Only the counters are written */
+  DYNSYS_PROF(ps, DYNSYS_FN_Q, q = s->q(s->x));
+#else
+  q = s->q(s->x);
+#endif
+  return s->c + q;
+}
+
+#if CONFIG_PROFILE
+static const char *const prof_names[DYNSYS_FN_COUNT] = {
+    [DYNSYS_FN_F] = "f (dynamics)",   [DYNSYS_FN_D] = "d (derivative)",
+    [DYNSYS_FN_U] = "u (control)",    [DYNSYS_FN_G] = "g (running cost)",
+    [DYNSYS_FN_Q] = "q (final cost)", [DYNSYS_FN_E] = "e (event)",
+};
+#endif
+
+void dynsys_prof_reset(dynsys_t *s) {
+#if CONFIG_PROFILE
+  memset(&s->prof, 0, sizeof(s->prof));
+#else
+  unused(s);
+#endif
+}
+
+void dynsys_prof_dump(const dynsys_t *s, FILE *out) {
+#if CONFIG_PROFILE
+  uint64_t total = 0;
+  for (unsigned i = 0; i < DYNSYS_FN_COUNT; i++) total += s->prof.ticks[i];
+
+  fprintf(out, "%-18s %12s %14s %8s\n", "function", "calls",
+          DYNSYS_PROF_UNIT "/call", "share");
+  for (unsigned i = 0; i < DYNSYS_FN_COUNT; i++) {
+    unsigned long calls = s->prof.calls[i];
+    if (calls == 0) continue;
+    fprintf(out, "%-18s %12lu %14.1f %7.1f%%\n", prof_names[i], calls,
+            (double)s->prof.ticks[i] / calls,
+            total > 0 ? 100.0 * s->prof.ticks[i] / total : 0.0);
+  }
+#else
+  unused(s);
+  unused(out);
+#endif
+}
+
+void dynsys_batch_init(dynsys_batch_t *s, void *x, size_t k, double *c,
+                       batch_dynamics_f f, batch_control_f u,
+                       batch_run_cost_f g, batch_term_cost_f q) {
+  assert(s != NULL);
+  assert(f != NULL);
+  assert(c != NULL || k == 0);
+  for (size_t i = 0; i < k; i++) {
+    c[i] = 0.0; /* No cost at start of game */
+  }
+  s->x = x;
+  s->k = k;
+  s->c = c;
+  s->f = f;
+  s->u = u;
+  s->g = g;
+  s->q = q;
+}
+
+void dynsys_batch_step(dynsys_batch_t *s, double dt) {
+  assert(s->f != NULL);
+  if (s->g != NULL) s->g(s->x, s->k, dt, s->c); /* Update running costs */
+  s->f(s->x, s->k, dt); /* Apply system dynamics to all instances */
+  if (s->u != NULL) s->u(s->x, s->k, dt); /* Update control variables */
+}
+
+void dynsys_batch_cost(const dynsys_batch_t *s, double *cost) {
+  for (size_t i = 0; i < s->k; i++) {
+    cost[i] = s->c[i];
+  }
+  if (s->q != NULL) s->q(s->x, s->k, cost);
+}
+
+/* Snapshot layout: the header, the private state, then the state variables if
+ * they live outside of the private state. Every part is aligned for any type.
+ */
+
+typedef struct {
+  double t;             /* Simulated time */
+  double c;             /* Game cost tally */
+  double h;             /* Next step size of the adaptive method */
+  dynsys_stats_t stats; /* Integrator statistics */
+  double u_next;        /* Simulated time the control is next due */
+  double u_last;        /* Simulated time of the last control update */
+  bool event;           /* True once the terminal event happened */
+} snap_hdr_t;
+
+#define SNAP_ALIGN(size)                                                       \
+  (((size) + _Alignof(max_align_t) - 1) & ~(_Alignof(max_align_t) - 1))
+
+/* True if the state variables aren't part of the private state */
+static bool vars_outside(const dynsys_t *s) {
+  uintptr_t x = (uintptr_t)s->x;
+  uintptr_t v = (uintptr_t)s->v;
+  return s->n > 0 && (v < x || v + sizeof(real_t) * s->n > x + s->size);
+}
+
+size_t dynsys_snapshot_size(const dynsys_t *s) {
+  assert(s->size > 0);
+  size_t size = SNAP_ALIGN(sizeof(snap_hdr_t)) + SNAP_ALIGN(s->size);
+  if (vars_outside(s)) size += SNAP_ALIGN(sizeof(real_t) * s->n);
+  if (s->save != NULL) size += s->save(s->x, NULL);
+  return size;
+}
+
+void dynsys_save(const dynsys_t *s, void *buf) {
+  snap_hdr_t *hdr = buf;
+  unsigned char *x = (unsigned char *)buf + SNAP_ALIGN(sizeof(snap_hdr_t));
+
+  hdr->t = s->t;
+  hdr->c = s->c;
+  hdr->h = s->h;
+  hdr->stats = s->stats;
+  hdr->u_next = s->u_next;
+  hdr->u_last = s->u_last;
+  hdr->event = s->event;
+  memcpy(x, s->x, s->size);
+  x += SNAP_ALIGN(s->size);
+  if (vars_outside(s)) {
+    memcpy(x, s->v, sizeof(real_t) * s->n);
+    x += SNAP_ALIGN(sizeof(real_t) * s->n);
+  }
+  if (s->save != NULL) s->save(s->x, x);
+}
+
+void dynsys_restore(dynsys_t *s, const void *buf) {
+  const snap_hdr_t *hdr = buf;
+  const unsigned char *x =
+      (const unsigned char *)buf + SNAP_ALIGN(sizeof(snap_hdr_t));
+
+  s->t = hdr->t;
+  s->c = hdr->c;
+  s->h = hdr->h;
+  s->stats = hdr->stats;
+  s->u_next = hdr->u_next;
+  s->u_last = hdr->u_last;
+  s->event = hdr->event;
+  memcpy(s->x, x, s->size);
+  x += SNAP_ALIGN(s->size);
+  if (vars_outside(s)) {
+    memcpy(s->v, x, sizeof(real_t) * s->n);
+    x += SNAP_ALIGN(sizeof(real_t) * s->n);
+  }
+  if (s->restore != NULL) s->restore(s->x, x);
+}
+
+void dynsys_fork(dynsys_t *dst, const dynsys_t *src) {
+  assert(dst->size == src->size && dst->n == src->n);
+  dst->t = src->t;
+  dst->c = src->c;
+  dst->h = src->h;
+  dst->stats = src->stats;
+  dst->u_next = src->u_next;
+  dst->u_last = src->u_last;
+  dst->event = src->event;
+
+  if (src->copy != NULL) {
+    src->copy(dst->x, src->x);
+    return;
+  }
+  memcpy(dst->x, src->x, src->size);
+  if (vars_outside(src)) memcpy(dst->v, src->v, sizeof(real_t) * src->n);
+}
+
+bool dynsys_arena_init(dynsys_arena_t *a, const dynsys_t *s, size_t cap) {
+  a->slot = SNAP_ALIGN(dynsys_snapshot_size(s));
+  a->buf = malloc(a->slot * cap);
+  if (a->buf == NULL) return false;
+  a->cap = cap;
+  a->n = 0;
+  return true;
+}
+
+void dynsys_arena_free(dynsys_arena_t *a) {
+  free(a->buf);
+  a->buf = NULL;
+}
+
+bool dynsys_checkpoint(dynsys_arena_t *a, const dynsys_t *s) {
+  if (a->n == a->cap) return false;
+  dynsys_save(s, a->buf + a->n * a->slot);
+  a->n++;
+  return true;
+}
+
+void dynsys_rollback(dynsys_arena_t *a, dynsys_t *s, size_t i) {
+  assert(i < a->n);
+  dynsys_restore(s, a->buf + i * a->slot);
+  a->n = i + 1;
 }
@@ -0,0 +1,166 @@
+/* Included files */
+
+#include <assert.h>
+#include <string.h>
+#include <time.h>
+
+#include "headless.h"
+
+void game_params_default(const game_desc_t *g, void *x) {
+  for (size_t i = 0; i < g->n_params; i++) {
+    game_param_set(g, x, g->params[i].name, g->params[i].def);
+  }
+}
+
+bool game_param_set(const game_desc_t *g, void *x, const char *name,
+                    double val) {
+  for (size_t i = 0; i < g->n_params; i++) {
+    const game_param_t *p = &g->params[i];
+    if (strcmp(p->name, name) != 0) continue;
+
+    switch (p->type) {
+    case PARAM_DOUBLE:
+      *(double *)((char *)x + p->offset) = val;
+      break;
+    case PARAM_REAL:
+      *(real_t *)((char *)x + p->offset) = (real_t)val;
+      break;
+    case PARAM_SIZE:
+      *(size_t *)((char *)x + p->offset) = (size_t)val;
+      break;
+    }
+    return true;
+  }
+  return false;
+}
+
+bool game_param_get(const game_desc_t *g, const void *x, const char *name,
+                    double *val) {
+  for (size_t i = 0; i < g->n_params; i++) {
+    const game_param_t *p = &g->params[i];
+    if (strcmp(p->name, name) != 0) continue;
+
+    switch (p->type) {
+    case PARAM_DOUBLE:
+      *val = *(const double *)((const char *)x + p->offset);
+      break;
+    case PARAM_REAL:
+      *val = *(const real_t *)((const char *)x + p->offset);
+      break;
+    case PARAM_SIZE:
+      *val = *(const size_t *)((const char *)x + p->offset);
+      break;
+    }
+    return true;
+  }
+  return false;
+}
+
+bool game_dynsys_init(const game_desc_t *g, dynsys_t *s, void *x) {
+  if (g->d != NULL) {
+    real_t *v;
+    size_t n = g->vars(x, &v);
+    if (!dynsys_init_ode(s, x, v, n, g->d, g->method, NULL, NULL, g->q)) {
+      return false;
+    }
+    dynsys_set_stepper(s, g->step);
+  } else {
+    dynsys_init(s, x, g->f, NULL, NULL, g->q);
+  }
+  dynsys_set_control(s, g->u, g->g, NULL);
+  if (g->event != NULL) dynsys_set_event(s, g->event, DYNSYS_EVENT_TOL);
+  dynsys_set_event_rate(s, g->event_rate);
+  dynsys_set_state(s, g->size, g->copy, g->save, g->restore);
+  return true;
+}
+
+double headless_now(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+void headless_run(dynsys_t *s, term_cond_f done, double dt, double t_max,
+                  headless_result_t *res) {
+  assert(dt > 0.0);
+  unsigned long steps = 0;
+  unsigned long max_steps = t_max / dt;
+  bool terminated = false;
+  bool adaptive = s->d != NULL && s->method == INTEGRATOR_RK45;
+  double t = 0.0;
+  double start = headless_now();
+
+  /* Count steps instead of accumulating time so that long runs don't suffer
+   * from floating point drift.
+   */
+
+  while (!adaptive && steps < max_steps && !s->event) {
+    if (done != NULL && done(s->x)) {
+      terminated = true;
+      break;
+    }
+    double h = dynsys_step(s, dt); /* Cut short by the terminal event */
+    t = h == dt ? (steps + 1) * dt : steps * dt + h;
+    if (h > 0.0) steps++;
+  }
+
+  /* Adaptive systems pick their own step sizes, so time is accumulated, but
+   * the last step is cut short to end exactly at the time limit. Their
+   * controller runs every dt as well, unless it has a period of its own, as
+   * holding the controls over the longest steps the error control allows
+   * would play a different game.
+   */
+
+  if (adaptive && s->u_period <= 0.0) dynsys_set_control_period(s, dt);
+
+  while (adaptive && t < t_max && !s->event) {
+    if (done != NULL && done(s->x)) {
+      terminated = true;
+      break;
+    }
+    double left = t_max - t;
+    double h = dynsys_step_adaptive(s, left);
+    t = h == left ? t_max : t + h;
+    steps++;
+  }
+
+  if (s->event) terminated = true;
+  if (!terminated && done != NULL) terminated = done(s->x);
+
+  res->wall = headless_now() - start;
+  res->steps = steps;
+  res->t = t;
+  res->terminated = terminated;
+  res->cost = dynsys_cost(s);
+  res->steps_per_sec = res->wall > 0.0 ? steps / res->wall : 0.0;
+}
+
+void headless_batch_run(dynsys_batch_t *s, batch_term_cond_f done, double dt,
+                        double t_max, double *t_end,
+                        headless_batch_result_t *res) {
+  assert(dt > 0.0);
+  assert(done != NULL);
+  unsigned long steps = 0;
+  unsigned long max_steps = t_max / dt;
+  size_t running = s->k;
+  double start = headless_now();
+
+  for (size_t i = 0; i < s->k; i++) {
+    t_end[i] = -1.0;
+  }
+
+  while (steps < max_steps) {
+    running = done(s->x, s->k, steps * dt, t_end);
+    if (running == 0) break;
+    dynsys_batch_step(s, dt);
+    steps++;
+  }
+
+  if (running != 0) running = done(s->x, s->k, steps * dt, t_end);
+
+  res->wall = headless_now() - start;
+  res->steps = steps;
+  res->t = steps * dt;
+  res->n_terminated = s->k - running;
+  res->steps_per_sec = res->wall > 0.0 ? (steps * s->k) / res->wall : 0.0;
+}
@@ -0,0 +1,260 @@
+/* Included files */
+
+#include <assert.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "montecarlo.h"
+
+/* Range of run numbers [head, tail) owned by a worker. Both ends are packed
+ * into one word so that they can be updated with a single compare-and-swap.
+ * The owner takes runs from the head, while thieves take them from the tail.
+ */
+
+#define RANGE_PACK(head, tail) (((uint64_t)(head) << 32) | (uint32_t)(tail))
+#define RANGE_HEAD(r) ((uint32_t)((r) >> 32))
+#define RANGE_TAIL(r) ((uint32_t)(r))
+
+#define CACHE_LINE (64)
+
+struct batch;
+
+struct worker {
+  _Alignas(CACHE_LINE) _Atomic uint64_t range; /* Runs left to do */
+  struct batch *batch;                         /* The batch being run */
+  unsigned id;                                 /* Index of this worker */
+  void *x;                                     /* Private game state */
+  pthread_t thread;                            /* Worker thread */
+};
+
+struct batch {
+  const mc_config_t *cfg; /* Batch configuration */
+  const void *tmpl;       /* Template game state */
+  mc_result_t *results;   /* Result buffer */
+  struct worker *workers; /* All workers */
+  unsigned n_workers;     /* Number of workers */
+};
+
+unsigned mc_nprocs(void) {
+  long n = sysconf(_SC_NPROCESSORS_ONLN);
+  return n > 0 ? (unsigned)n : 1;
+}
+
+/* Takes the next run from the head of a worker's own range */
+static bool range_pop(_Atomic uint64_t *range, uint32_t *run) {
+  uint64_t r = atomic_load_explicit(range, memory_order_relaxed);
+  do {
+    if (RANGE_HEAD(r) >= RANGE_TAIL(r)) return false;
+  } while (!atomic_compare_exchange_weak(
+      range, &r, RANGE_PACK(RANGE_HEAD(r) + 1, RANGE_TAIL(r))));
+  *run = RANGE_HEAD(r);
+  return true;
+}
+
+/* Takes half of the remaining runs from the tail of a victim's range */
+static bool range_steal(_Atomic uint64_t *range, uint32_t *head,
+                        uint32_t *tail) {
+  uint64_t r = atomic_load_explicit(range, memory_order_relaxed);
+  uint32_t h;
+  uint32_t t;
+  uint32_t k;
+  do {
+    h = RANGE_HEAD(r);
+    t = RANGE_TAIL(r);
+    if (h >= t) return false;
+    k = (t - h + 1) / 2;
+  } while (!atomic_compare_exchange_weak(range, &r, RANGE_PACK(h, t - k)));
+  *head = t - k;
+  *tail = t;
+  return true;
+}
+
+/* Refills an idle worker's range from the worker with the most runs left */
+static bool worker_steal(struct worker *w) {
+  struct batch *b = w->batch;
+  uint32_t head;
+  uint32_t tail;
+
+  for (;;) {
+    struct worker *victim = NULL;
+    uint32_t most = 0;
+
+    for (unsigned i = 1; i < b->n_workers; i++) {
+      struct worker *v = &b->workers[(w->id + i) % b->n_workers];
+      uint64_t r = atomic_load_explicit(&v->range, memory_order_relaxed);
+      if (RANGE_HEAD(r) < RANGE_TAIL(r) &&
+          RANGE_TAIL(r) - RANGE_HEAD(r) > most) {
+        most = RANGE_TAIL(r) - RANGE_HEAD(r);
+        victim = v;
+      }
+    }
+
+    /* Runs are never added, so once every range is empty we're done */
+
+    if (victim == NULL) return false;
+
+    if (range_steal(&victim->range, &head, &tail)) {
+      atomic_store(&w->range, RANGE_PACK(head, tail));
+      return true;
+    }
+  }
+}
+
+/* Simulates a single run in the worker's private game state */
+static void worker_run(struct worker *w, uint32_t run) {
+  const mc_config_t *cfg = w->batch->cfg;
+  const game_desc_t *g = cfg->game;
+  mc_result_t *res = &w->batch->results[run];
+  headless_result_t hres;
+  dynsys_t s;
+  rng_t rng;
+
+  /* Every run has its own stream, so results don't depend on the threads */
+
+  memcpy(w->x, w->batch->tmpl, g->size);
+  res->seed = cfg->seed + run;
+  rng_seed(&rng, res->seed);
+  res->ok = g->init(w->x, cfg->w, cfg->h, &rng);
+  if (!res->ok) {
+    res->terminated = false;
+    res->steps = 0;
+    res->t = 0.0;
+    res->cost = 0.0;
+    return;
+  }
+
+  res->ok = game_dynsys_init(g, &s, w->x);
+  if (!res->ok) {
+    if (g->free != NULL) g->free(w->x);
+    res->terminated = false;
+    res->steps = 0;
+    res->t = 0.0;
+    res->cost = 0.0;
+    return;
+  }
+
+  headless_run(&s, g->done, cfg->dt, cfg->t_max, &hres);
+  dynsys_free(&s);
+  if (g->free != NULL) g->free(w->x);
+
+  res->terminated = hres.terminated;
+  res->steps = hres.steps;
+  res->t = hres.t;
+  res->cost = hres.cost;
+}
+
+static void *worker_main(void *arg) {
+  struct worker *w = (struct worker *)arg;
+  uint32_t run;
+
+  do {
+    while (range_pop(&w->range, &run)) {
+      worker_run(w, run);
+    }
+  } while (worker_steal(w));
+
+  return NULL;
+}
+
+bool mc_run(const mc_config_t *cfg, mc_result_t *results,
+            mc_summary_t *summary) {
+  assert(cfg->game != NULL);
+  assert(cfg->n_runs <= UINT32_MAX);
+  struct batch b = {.cfg = cfg, .results = results};
+  void *tmpl = NULL;
+  unsigned started = 0;
+  bool ok = true;
+  double start = headless_now();
+
+  /* Parameters come from the template, or the game's defaults */
+
+  b.tmpl = cfg->tmpl;
+  if (b.tmpl == NULL) {
+    tmpl = calloc(1, cfg->game->size);
+    if (tmpl == NULL) return false;
+    game_params_default(cfg->game, tmpl);
+    b.tmpl = tmpl;
+  }
+
+  b.n_workers = cfg->n_threads == 0 ? mc_nprocs() : cfg->n_threads;
+  if (b.n_workers > cfg->n_runs) b.n_workers = cfg->n_runs;
+  if (b.n_workers == 0) b.n_workers = 1;
+
+  b.workers = aligned_alloc(CACHE_LINE, sizeof(struct worker) * b.n_workers);
+  if (b.workers == NULL) {
+    free(tmpl);
+    return false;
+  }
+
+  /* Split the runs evenly between the workers to begin with */
+
+  for (unsigned i = 0; i < b.n_workers; i++) {
+    struct worker *w = &b.workers[i];
+    uint32_t head = (cfg->n_runs * i) / b.n_workers;
+    uint32_t tail = (cfg->n_runs * (i + 1)) / b.n_workers;
+    atomic_init(&w->range, RANGE_PACK(head, tail));
+    w->batch = &b;
+    w->id = i;
+    w->x = malloc(cfg->game->size);
+    if (w->x == NULL) ok = false;
+  }
+
+  for (unsigned i = 0; ok && i < b.n_workers; i++) {
+    if (pthread_create(&b.workers[i].thread, NULL, worker_main,
+                       &b.workers[i]) != 0) {
+      break;
+    }
+    started++;
+  }
+
+  /* If a thread couldn't be started, the others steal its runs */
+
+  for (unsigned i = 0; i < started; i++) {
+    pthread_join(b.workers[i].thread, NULL);
+  }
+  if (started == 0) ok = false;
+
+  if (ok && summary != NULL) {
+    mc_summarize(results, cfg->n_runs, summary);
+    summary->wall = headless_now() - start;
+    summary->steps_per_sec =
+        summary->wall > 0.0 ? summary->steps / summary->wall : 0.0;
+  }
+
+  for (unsigned i = 0; i < b.n_workers; i++) {
+    free(b.workers[i].x);
+  }
+  free(b.workers);
+  free(tmpl);
+  return ok;
+}
+
+void mc_summarize(const mc_result_t *results, size_t n, mc_summary_t *summary) {
+  double sum_t = 0.0;
+  double sum_cost = 0.0;
+
+  memset(summary, 0, sizeof(*summary));
+
+  for (size_t i = 0; i < n; i++) {
+    if (!results[i].ok) continue;
+    summary->n_runs++;
+    summary->steps += results[i].steps;
+    sum_cost += results[i].cost;
+    if (results[i].terminated) {
+      summary->n_terminated++;
+      sum_t += results[i].t;
+    }
+  }
+
+  if (summary->n_runs > 0) {
+    summary->p_terminated = (double)summary->n_terminated / summary->n_runs;
+    summary->mean_cost = sum_cost / summary->n_runs;
+  }
+  if (summary->n_terminated > 0) {
+    summary->mean_t = sum_t / summary->n_terminated;
+  }
+}
@@ -0,0 +1,171 @@
+/* Included files */
+
+#include <assert.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "recorder.h"
+
+bool recorder_open(recorder_t *r, const char *path, const char *game,
+                   size_t n_vars, size_t agent_vars, double dt,
+                   uint64_t capacity, uint64_t max_capacity) {
+  size_t record_size = sizeof(double) * RECORDER_STRIDE(n_vars);
+
+  r->fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (r->fd < 0) return false;
+
+  /* The file is sparse until records are written, so a generous capacity
+   * costs address space but no disk space.
+   */
+
+  assert(capacity > 0 && capacity <= max_capacity);
+
+  r->map_size = sizeof(recorder_header_t) + record_size * capacity;
+  if (ftruncate(r->fd, r->map_size) != 0) goto err_close;
+
+  r->map =
+      mmap(NULL, r->map_size, PROT_READ | PROT_WRITE, MAP_SHARED, r->fd, 0);
+  if (r->map == MAP_FAILED) goto err_close;
+  posix_madvise(r->map, r->map_size, POSIX_MADV_SEQUENTIAL);
+
+  recorder_header_t *hdr = r->map;
+  memset(hdr, 0, sizeof(*hdr));
+  strncpy(hdr->magic, RECORDER_MAGIC, sizeof(hdr->magic));
+  hdr->version = RECORDER_VERSION;
+  hdr->header_size = sizeof(recorder_header_t);
+  strncpy(hdr->game, game, RECORDER_NAME_LEN - 1);
+  hdr->n_vars = n_vars;
+  hdr->agent_vars = agent_vars;
+  hdr->n_agents = agent_vars > 0 ? n_vars / agent_vars : 0;
+  hdr->record_size = record_size;
+  hdr->dt = dt;
+  hdr->var_size = sizeof(real_t);
+
+  r->next = (double *)(hdr + 1);
+  r->n_vars = n_vars;
+  r->stride = RECORDER_STRIDE(n_vars);
+  r->n_records = 0;
+  r->capacity = capacity;
+  r->max_cap = max_capacity;
+  r->dropped = 0;
+  r->t = 0.0;
+  return true;
+
+err_close:
+  close(r->fd);
+  unlink(path);
+  return false;
+}
+
+bool recorder_grow(recorder_t *r) {
+  if (r->capacity >= r->max_cap) return false;
+
+  uint64_t capacity =
+      r->capacity > r->max_cap / 2 ? r->max_cap : 2 * r->capacity;
+  size_t record_size = sizeof(double) * r->stride;
+  size_t map_size = sizeof(recorder_header_t) + record_size * capacity;
+
+  /* On failure the file keeps its records, and closing trims any growth */
+
+  void *map = MAP_FAILED;
+  if (ftruncate(r->fd, map_size) == 0) {
+    map = mmap(NULL, map_size, PROT_READ | PROT_WRITE, MAP_SHARED, r->fd, 0);
+  }
+  if (map == MAP_FAILED) {
+    r->max_cap = r->capacity;
+    return false;
+  }
+
+  munmap(r->map, r->map_size);
+  posix_madvise(map, map_size, POSIX_MADV_SEQUENTIAL);
+  r->map = map;
+  r->map_size = map_size;
+  r->next = (double *)((recorder_header_t *)map + 1) + r->n_records * r->stride;
+  r->capacity = capacity;
+  return true;
+}
+
+bool recorder_close(recorder_t *r) {
+  recorder_header_t *hdr = r->map;
+  bool ok = true;
+
+  hdr->n_records = r->n_records;
+  off_t size = sizeof(recorder_header_t) + hdr->record_size * r->n_records;
+
+  if (munmap(r->map, r->map_size) != 0) ok = false;
+  if (ftruncate(r->fd, size) != 0) ok = false;
+  if (close(r->fd) != 0) ok = false;
+
+  r->map = NULL;
+  return ok;
+}
+
+bool trajectory_open(trajectory_t *t, const char *path) {
+  struct stat st;
+
+  t->fd = open(path, O_RDONLY);
+  if (t->fd < 0) return false;
+  if (fstat(t->fd, &st) != 0 ||
+      (size_t)st.st_size < sizeof(recorder_header_t)) {
+    close(t->fd);
+    return false;
+  }
+
+  t->map_size = st.st_size;
+  t->map = mmap(NULL, t->map_size, PROT_READ, MAP_SHARED, t->fd, 0);
+  if (t->map == MAP_FAILED) {
+    close(t->fd);
+    return false;
+  }
+
+  /* Check the header before trusting any of the sizes in it */
+
+  const recorder_header_t *hdr = t->map;
+  bool ok = strncmp(hdr->magic, RECORDER_MAGIC, sizeof(hdr->magic)) == 0 &&
+            hdr->version == RECORDER_VERSION &&
+            hdr->header_size == sizeof(recorder_header_t) &&
+            hdr->var_size == sizeof(real_t) &&
+            hdr->record_size ==
+                sizeof(double) * RECORDER_STRIDE(hdr->n_vars) &&
+            hdr->n_records > 0 &&
+            hdr->n_records <= (t->map_size - hdr->header_size) /
+                                  hdr->record_size;
+  if (!ok) {
+    trajectory_close(t);
+    return false;
+  }
+
+  t->hdr = hdr;
+  t->records = (const double *)(hdr + 1);
+  t->stride = RECORDER_STRIDE(hdr->n_vars);
+  t->n = hdr->n_records;
+  return true;
+}
+
+void trajectory_close(trajectory_t *t) {
+  munmap((void *)t->map, t->map_size);
+  close(t->fd);
+  t->map = NULL;
+}
+
+uint64_t trajectory_seek(const trajectory_t *t, double time) {
+  uint64_t lo = 0;
+  uint64_t hi = t->n;
+
+  /* Invariant: records before lo are at or before time, records from hi on
+   * are after it.
+   */
+
+  while (lo < hi) {
+    uint64_t mid = lo + (hi - lo) / 2;
+    if (trajectory_time(t, mid) <= time) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+
+  return lo > 0 ? lo - 1 : 0;
+}
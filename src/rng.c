@@ -0,0 +1,67 @@
+/* Included files */
+
+#include "rng.h"
+
+/* Spreads a seed over 64 bits at a time (splitmix64) */
+static uint64_t splitmix64(uint64_t *x) {
+  uint64_t z = (*x += 0x9e3779b97f4a7c15);
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+  return z ^ (z >> 31);
+}
+
+void rng_seed(rng_t *r, uint64_t seed) {
+  for (int i = 0; i < 4; i++) r->s[i] = splitmix64(&seed);
+}
+
+/* Advances the generator by the jump polynomial `poly` */
+static void rng_jump_by(rng_t *r, const uint64_t poly[4]) {
+  uint64_t s[4] = {0, 0, 0, 0};
+
+  for (int i = 0; i < 4; i++) {
+    for (int b = 0; b < 64; b++) {
+      if (poly[i] & (UINT64_C(1) << b)) {
+        s[0] ^= r->s[0];
+        s[1] ^= r->s[1];
+        s[2] ^= r->s[2];
+        s[3] ^= r->s[3];
+      }
+      rng_next(r);
+    }
+  }
+
+  for (int i = 0; i < 4; i++) r->s[i] = s[i];
+}
+
+void rng_jump(rng_t *r) {
+  static const uint64_t poly[4] = {0x180ec6d33cfd0aba, 0xd5a61266f0c9392c,
+                                   0xa9582618e03fc9aa, 0x39abdc4529b1661c};
+  rng_jump_by(r, poly);
+}
+
+void rng_long_jump(rng_t *r) {
+  static const uint64_t poly[4] = {0x76e15d3efefdcbbf, 0xc5004e441c522fb3,
+                                   0x77710069854ee241, 0x39109bb02acbe635};
+  rng_jump_by(r, poly);
+}
+
+void rng_split(rng_t *r, rng_t *sub) {
+  *sub = *r;
+  rng_jump(r);
+}
+
+void rng_fill(rng_t *r, real_t *out, size_t n, double min, double max) {
+  rng_fill_strided(r, out, n, 1, min, max);
+}
+
+void rng_fill_strided(rng_t *r, real_t *out, size_t n, size_t stride,
+                      double min, double max) {
+  rng_t g = *r; /* Local copy, so that the state stays in registers */
+  double span = max - min;
+
+  for (size_t i = 0; i < n; i++) {
+    out[i * stride] = min + span * rng_double(&g);
+  }
+
+  *r = g;
+}
@@ -0,0 +1,63 @@
+/* Included files */
+
+#include <assert.h>
+#include <math.h>
+
+#include "simloop.h"
+
+/* Steps between clock reads when running as fast as possible */
+
+#define FAST_CHECK (64)
+
+void simloop_init(simloop_t *l, double dt, double rate) {
+  assert(dt > 0.0);
+  l->dt = dt;
+  l->rate = rate;
+  l->last = headless_now();
+  simloop_reset(l);
+}
+
+void simloop_reset(simloop_t *l) {
+  l->lag = 0.0;
+  l->t = 0.0;
+  l->over = false;
+}
+
+/* Takes a single time-step, unless the game is over */
+static bool simloop_step(simloop_t *l, dynsys_t *s, term_cond_f done) {
+  if (done != NULL && done(s->x)) l->over = true;
+  if (l->over) return false;
+
+  l->t += dynsys_step(s, l->dt);
+  if (s->event) l->over = true;
+  return true;
+}
+
+unsigned long simloop_advance(simloop_t *l, dynsys_t *s, term_cond_f done) {
+  double now = headless_now();
+  double elapsed = now - l->last;
+  unsigned long steps = 0;
+
+  l->last = now;
+
+  if (l->rate <= SIMLOOP_FAST) {
+    double deadline = now + SIMLOOP_BUDGET;
+    while (simloop_step(l, s, done)) {
+      steps++;
+      if (steps % FAST_CHECK == 0 && headless_now() >= deadline) break;
+    }
+    return steps;
+  }
+
+  /* Don't try to catch up after long stalls (i.e. the window being dragged),
+   * or every following frame falls further behind.
+   */
+
+  l->lag += fmin(elapsed, SIMLOOP_MAX_LAG) * l->rate;
+  while (l->lag >= l->dt && simloop_step(l, s, done)) {
+    l->lag -= l->dt;
+    steps++;
+  }
+
+  return steps;
+}
@@ -0,0 +1,89 @@
+/* Included files */
+
+#include <time.h>
+
+#include "simthread.h"
+
+/* Publishes the current state of the game */
+static void simthread_publish(simthread_t *t) {
+  simthread_snap_t *snap = tribuf_back(&t->snaps);
+  snap->gen = t->gen;
+  snap->t = t->loop.t;
+  snap->over = t->loop.over;
+  t->cfg.snap(snap->data, t->cfg.s->x);
+  tribuf_publish(&t->snaps);
+}
+
+/* Sleeps until the next time-step is due. Running as fast as possible never
+ * sleeps, unless the game is over.
+ */
+static void simthread_idle(const simthread_t *t) {
+  double wait = SIMTHREAD_IDLE;
+
+  if (!t->loop.over) {
+    if (t->loop.rate <= SIMLOOP_FAST) return;
+    wait = (t->loop.dt - t->loop.lag) / t->loop.rate;
+  }
+
+  struct timespec ts = {.tv_sec = (time_t)wait};
+  ts.tv_nsec = (long)((wait - ts.tv_sec) * 1e9);
+  nanosleep(&ts, NULL);
+}
+
+static void *simthread_main(void *arg) {
+  simthread_t *t = (simthread_t *)arg;
+
+  while (!atomic_load(&t->quit)) {
+    unsigned long restarts = atomic_load(&t->restarts);
+    if (restarts != t->gen) {
+      if (t->cfg.restart != NULL && !t->cfg.restart(t->cfg.ctx)) {
+        atomic_store(&t->failed, true);
+        break;
+      }
+      t->gen = restarts;
+      simloop_reset(&t->loop);
+    }
+
+    simloop_advance(&t->loop, t->cfg.s, t->cfg.done);
+    simthread_publish(t);
+    simthread_idle(t);
+  }
+
+  return NULL;
+}
+
+bool simthread_start(simthread_t *t, const simthread_cfg_t *cfg) {
+  t->cfg = *cfg;
+  t->gen = 0;
+  atomic_init(&t->restarts, 0);
+  atomic_init(&t->quit, false);
+  atomic_init(&t->failed, false);
+
+  if (!tribuf_init(&t->snaps, sizeof(simthread_snap_t) + cfg->snap_size)) {
+    return false;
+  }
+
+  simloop_init(&t->loop, cfg->dt, cfg->rate);
+  simthread_publish(t);
+
+  if (pthread_create(&t->thread, NULL, simthread_main, t) != 0) {
+    tribuf_free(&t->snaps);
+    return false;
+  }
+
+  return true;
+}
+
+void simthread_stop(simthread_t *t) {
+  atomic_store(&t->quit, true);
+  pthread_join(t->thread, NULL);
+  tribuf_free(&t->snaps);
+}
+
+unsigned long simthread_restart(simthread_t *t) {
+  return atomic_fetch_add(&t->restarts, 1) + 1;
+}
+
+const simthread_snap_t *simthread_latest(simthread_t *t) {
+  return tribuf_front(&t->snaps);
+}
@@ -0,0 +1,52 @@
+/* Included files */
+
+#include <stdlib.h>
+
+#include "tribuf.h"
+
+/* The middle index keeps a flag telling the reader it holds a snapshot which
+ * it hasn't seen yet.
+ */
+
+#define FRESH (4u)
+#define INDEX(m) ((m) & 3u)
+
+bool tribuf_init(tribuf_t *b, size_t size) {
+  for (unsigned i = 0; i < 3; i++) {
+    b->buf[i] = calloc(1, size);
+    if (b->buf[i] == NULL) {
+      while (i-- > 0) free(b->buf[i]);
+      return false;
+    }
+  }
+
+  b->size = size;
+  b->back = 0;
+  b->front = 2;
+  atomic_init(&b->mid, 1);
+  return true;
+}
+
+void tribuf_free(tribuf_t *b) {
+  for (unsigned i = 0; i < 3; i++) {
+    free(b->buf[i]);
+    b->buf[i] = NULL;
+  }
+}
+
+void *tribuf_back(tribuf_t *b) { return b->buf[b->back]; }
+
+void tribuf_publish(tribuf_t *b) {
+  unsigned m = atomic_exchange_explicit(&b->mid, b->back | FRESH,
+                                        memory_order_acq_rel);
+  b->back = INDEX(m);
+}
+
+const void *tribuf_front(tribuf_t *b) {
+  if (atomic_load_explicit(&b->mid, memory_order_relaxed) & FRESH) {
+    unsigned m =
+        atomic_exchange_explicit(&b->mid, b->front, memory_order_acq_rel);
+    b->front = INDEX(m);
+  }
+  return b->buf[b->front];
+}
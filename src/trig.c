@@ -0,0 +1,25 @@
+/* Included files */
+
+#include "simd.h"
+#include "trig.h"
+
+SIMD_INLINE void trig_batch_sincos_k(const real_t *x, real_t *s, real_t *c,
+                                     size_t n) {
+  for (size_t k = 0; k < n; k++) {
+    real_sincos(x[k], &s[k], &c[k]);
+  }
+}
+
+SIMD_KERNEL(trig_batch_sincos,
+            (const real_t *x, real_t *s, real_t *c, size_t n), (x, s, c, n))
+
+SIMD_INLINE void trig_batch_atan2_k(const real_t *y, const real_t *x,
+                                    real_t *res, size_t n) {
+  for (size_t k = 0; k < n; k++) {
+    res[k] = real_atan2(y[k], x[k]);
+  }
+}
+
+SIMD_KERNEL(trig_batch_atan2,
+            (const real_t *y, const real_t *x, real_t *res, size_t n),
+            (y, x, res, n))
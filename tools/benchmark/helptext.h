@@ -0,0 +1,42 @@
+#define HELP_TEXT \
+"Benchmark\n\nDESCRIPTION:\n    Measures how fast a single example game is st" \
+"epped, without initializing\n    SDL. One binary is built per example game, " \
+"named <example>-benchmark.\n\n    The game starts from fixed random initial " \
+"conditions, is stepped for a\n    number of untimed warmup steps, then for t" \
+"he same number of timed steps in\n    every repetition. Each repetition star" \
+"ts from the same initial conditions,\n    and whenever the game ends it is r" \
+"olled back to them and carries on, so\n    every repetition does the same wo" \
+"rk. Only the steps themselves are timed.\n    The benchmark fails if a repet" \
+"ition doesn't end in the same state as the\n    first one, since the rollbac" \
+"ks must replay the game exactly.\n    The median, minimum, mean and standard" \
+" deviation of the time per step over\n    the repetitions are printed, along" \
+" with the number of allocations made\n    while stepping (which should be 0)" \
+" and while setting up the game.\n\n    With -k, K instances of the game are " \
+"stepped at once with its batched\n    variant (currently 2p2e), from fresh i" \
+"nitial conditions in every\n    repetition. Instances which end are frozen b" \
+"ut still stepped, and the time\n    per step is that of a single instance.\n" \
+"\n    `make bench` runs the benchmark of every example game, with npne at se" \
+"veral\n    numbers of agents and 2p2e batched, and writes the results to ben" \
+"ch.json.\n\nUSAGE:\n    <example>-benchmark [OPTIONS]\n\nOPTIONS:\n    -h   " \
+"           Display this help text.\n    -n <steps>      Timed steps per repe" \
+"tition. Default 100000.\n    -w <steps>      Untimed warmup steps. Default 1" \
+"0000.\n    -r <reps>       Repetitions. Default 5.\n    -k <instances>  Step" \
+" this many instances at once with the game's batched\n                    va" \
+"riant. Steps are then steps of the whole batch.\n    -x <width>      Arena w" \
+"idth in meters. Default 192.\n    -y <height>     Arena height in meters. De" \
+"fault 108.\n    -d <dt>         Time-step in seconds. Default is the game's " \
+"time-step.\n    -S <seed>       Seed for the initial conditions. Default 1, " \
+"so that results\n                    of different builds can be compared.\n " \
+"   -p <name=value> Set a game parameter, i.e. -p n=4. May be given multiple" \
+"\n                    times.\n    -i <method>     Integration method: euler," \
+" rk2, rk4 or rk45. Default is the\n                    game's method. rk45 t" \
+"akes steps of at most -d.\n    -u <period>     Control period in seconds: th" \
+"e game's controller runs once\n                    per <period> of simulated" \
+" time and its controls are held\n                    in between. Default 0, " \
+"after every time-step.\n    -o <file>       Append the results to <file> as " \
+"a single line of JSON: the\n                    game, its parameters, the me" \
+"thod, time-step and control\n                    period, the step counts, th" \
+"e time per step statistics in\n                    ns, the steps/sec, the al" \
+"location counts, the compiler\n                    which built the benchmark" \
+", its scalar type and whether it\n                    uses the fast trigonom" \
+"etric approximations.\n"
@@ -0,0 +1,475 @@
+/* Benchmark front-end which measures how fast an example game is stepped. The
+ * example is selected at link time by its game.c, which provides `game_desc`.
+ */
+
+#include <getopt.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "dynsys.h"
+#include "game.h"
+#include "headless.h"
+#include "helptext.h"
+#include "trig.h"
+
+/* Default arena size, half of a 1920x1080 screen at the examples' default
+ * rendering scale of 5.
+ */
+
+#define ARENA_WIDTH (192.0)
+#define ARENA_HEIGHT (108.0)
+
+#define N_STEPS (100000) /* Timed steps per repetition */
+#define N_WARMUP (10000) /* Untimed steps before the first repetition */
+#define N_REPS (5)       /* Repetitions */
+#define SEED (1)         /* Same initial conditions for every build */
+
+/* Allocation counting
+ *
+ * The benchmark is linked with `--wrap` for every allocation function, so that
+ * the calls made by the games and the library land here first.
+ */
+
+static unsigned long allocs = 0;
+
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t n, size_t size);
+void *__real_realloc(void *ptr, size_t size);
+void *__real_aligned_alloc(size_t align, size_t size);
+
+void *__wrap_malloc(size_t size) {
+  allocs++;
+  return __real_malloc(size);
+}
+
+void *__wrap_calloc(size_t n, size_t size) {
+  allocs++;
+  return __real_calloc(n, size);
+}
+
+void *__wrap_realloc(void *ptr, size_t size) {
+  allocs++;
+  return __real_realloc(ptr, size);
+}
+
+void *__wrap_aligned_alloc(size_t align, size_t size) {
+  allocs++;
+  return __real_aligned_alloc(align, size);
+}
+
+/* Timing statistics over the repetitions, in ns/step */
+
+typedef struct {
+  double min;
+  double median;
+  double mean;
+  double stddev;
+} bench_stats_t;
+
+typedef struct {
+  size_t k;               /* Instances stepped at once, 1 unless batched */
+  unsigned long steps;    /* Timed steps per repetition */
+  unsigned long warmup;   /* Untimed steps before the first repetition */
+  unsigned long reps;     /* Repetitions */
+  unsigned long restarts; /* Times the game ended and was rolled back */
+  unsigned long allocs;   /* Allocations during the timed steps */
+  unsigned long setup;    /* Allocations setting up the game */
+  bench_stats_t ns;       /* Time per step of a single instance */
+  double steps_per_sec;   /* Throughput at the median time per step */
+} bench_result_t;
+
+/* Parse the name of an integration method */
+static enum integrator_e parse_integrator(const char *name) {
+  if (strcmp(name, "euler") == 0) return INTEGRATOR_EULER;
+  if (strcmp(name, "rk2") == 0) return INTEGRATOR_RK2;
+  if (strcmp(name, "rk4") == 0) return INTEGRATOR_RK4;
+  if (strcmp(name, "rk45") == 0) return INTEGRATOR_RK45;
+  fprintf(stderr, "Unknown integrator '%s'\n", name);
+  exit(EXIT_FAILURE);
+}
+
+static const char *integrator_name(enum integrator_e method) {
+  switch (method) {
+  case INTEGRATOR_EULER:
+    return "euler";
+  case INTEGRATOR_RK2:
+    return "rk2";
+  case INTEGRATOR_RK4:
+    return "rk4";
+  case INTEGRATOR_RK45:
+    return "rk45";
+  }
+  return "unknown";
+}
+
+/* Parse a parameter override of the form name=value */
+static void parse_param(void *x, char *arg) {
+  char *eq = strchr(arg, '=');
+  if (eq == NULL) {
+    fprintf(stderr, "Parameter must be given as name=value: %s\n", arg);
+    exit(EXIT_FAILURE);
+  }
+
+  *eq = '\0';
+  if (!game_param_set(&game_desc, x, arg, strtod(eq + 1, NULL))) {
+    fprintf(stderr, "%s has no parameter '%s'\n", game_desc.name, arg);
+    exit(EXIT_FAILURE);
+  }
+}
+
+static int cmp_double(const void *a, const void *b) {
+  double x = *(const double *)a;
+  double y = *(const double *)b;
+  return (x > y) - (x < y);
+}
+
+/* Sorts the samples to compute their statistics */
+static void stats(double *ns, size_t n, bench_stats_t *st) {
+  double sum = 0.0;
+  double sq = 0.0;
+
+  qsort(ns, n, sizeof(double), cmp_double);
+  for (size_t i = 0; i < n; i++) sum += ns[i];
+  st->mean = sum / n;
+  for (size_t i = 0; i < n; i++) sq += (ns[i] - st->mean) * (ns[i] - st->mean);
+
+  st->min = ns[0];
+  st->median = n % 2 ? ns[n / 2] : 0.5 * (ns[n / 2 - 1] + ns[n / 2]);
+  st->stddev = n > 1 ? sqrt(sq / (n - 1)) : 0.0;
+}
+
+/* Steps the game `n` times, rolling it back to its initial conditions whenever
+ * it ends. Only the stepping is timed, the rollbacks aren't.
+ *
+ * Returns: The wall time of the steps in seconds.
+ */
+static double run(dynsys_t *s, dynsys_arena_t *a, double dt, unsigned long n,
+                  bench_result_t *res) {
+  bool adaptive = s->method == INTEGRATOR_RK45;
+  term_cond_f done = game_desc.done;
+  double wall = 0.0;
+
+  while (n > 0) {
+    double start = headless_now();
+    while (n > 0 && !s->event && (done == NULL || !done(s->x))) {
+      if (adaptive) {
+        dynsys_step_adaptive(s, dt);
+      } else {
+        dynsys_step(s, dt);
+      }
+      n--;
+    }
+    wall += headless_now() - start;
+
+    if (n > 0) {
+      dynsys_rollback(a, s, 0);
+      res->restarts++;
+    }
+  }
+
+  return wall;
+}
+
+/* Steps K instances of the game's batched variant `n` times from the initial
+ * conditions of the seed. Instances which end are frozen by the game but still
+ * stepped, so every step does the same work. Only the steps are timed.
+ *
+ * Returns: The wall time of the steps in seconds, or a negative value if the
+ * batch could not be initialized.
+ */
+static double run_batch(const void *tmpl, double w, double h, unsigned seed,
+                        double dt, unsigned long n, bench_result_t *res) {
+  const game_batch_desc_t *bd = game_desc.batch;
+  size_t k = res->k;
+  dynsys_batch_t batch;
+  rng_t rng;
+  double wall = -1.0;
+
+  unsigned long before = allocs;
+  void *batch_x = calloc(1, bd->size);
+  double *c = malloc(sizeof(double) * k);
+  double *t_end = malloc(sizeof(double) * k);
+  if (batch_x == NULL || c == NULL || t_end == NULL) goto out;
+
+  rng_seed(&rng, seed);
+  if (!bd->init(batch_x, tmpl, k, w, h, &rng)) goto out;
+  dynsys_batch_init(&batch, batch_x, k, c, bd->f, bd->u, bd->g, bd->q);
+  res->setup = allocs - before;
+
+  before = allocs;
+  double start = headless_now();
+  for (unsigned long i = 0; i < n; i++) {
+    dynsys_batch_step(&batch, dt);
+    bd->done(batch_x, k, (i + 1) * dt, t_end);
+  }
+  wall = headless_now() - start;
+  res->allocs += allocs - before;
+  bd->free(batch_x);
+
+out:
+  free(batch_x);
+  free(c);
+  free(t_end);
+  return wall;
+}
+
+/* Write the result as a single line of JSON */
+static void write_json(FILE *f, const void *x, const dynsys_t *s, double dt,
+                       const bench_result_t *res) {
+  double v;
+
+  fprintf(f, "{\"game\":\"%s\",\"params\":{", game_desc.name);
+  for (size_t i = 0; i < game_desc.n_params; i++) {
+    const char *name = game_desc.params[i].name;
+    game_param_get(&game_desc, x, name, &v);
+    fprintf(f, "%s\"%s\":%.17g", i > 0 ? "," : "", name, v);
+  }
+  fprintf(f, "},\"method\":\"%s\",\"dt\":%.17g,\"u_period\":%.17g,",
+          integrator_name(s->method), dt, s->u_period);
+  fprintf(f, "\"instances\":%zu,", res->k);
+  fprintf(f, "\"steps\":%lu,\"warmup\":%lu,\"reps\":%lu,\"restarts\":%lu,",
+          res->steps, res->warmup, res->reps, res->restarts);
+  fprintf(f, "\"ns_per_step\":{\"min\":%.3f,\"median\":%.3f,\"mean\":%.3f,"
+             "\"stddev\":%.3f},",
+          res->ns.min, res->ns.median, res->ns.mean, res->ns.stddev);
+  fprintf(f, "\"steps_per_sec\":%.0f,", res->steps_per_sec);
+  fprintf(f, "\"allocs\":%lu,\"setup_allocs\":%lu,", res->allocs, res->setup);
+  fprintf(f,
+          "\"build\":{\"cc\":\"%s\",\"profile\":%d,\"real\":\"%s\","
+          "\"trig\":\"%s\"}}\n",
+          __VERSION__, CONFIG_PROFILE, REAL_NAME, TRIG_NAME);
+}
+
+int main(int argc, char **argv) {
+  double w = ARENA_WIDTH;
+  double h = ARENA_HEIGHT;
+  double dt = game_desc.dt;
+  double u_period = 0.0;
+  unsigned seed = SEED;
+  const char *out = NULL;
+  rng_t rng;
+  enum integrator_e method = game_desc.method;
+  bool set_method = false;
+  bench_result_t res = {
+      .k = 1,
+      .steps = N_STEPS,
+      .warmup = N_WARMUP,
+      .reps = N_REPS,
+  };
+  dynsys_arena_t arena;
+  dynsys_t game;
+
+  void *game_x = calloc(1, game_desc.size);
+  if (game_x == NULL) {
+    fprintf(stderr, "Couldn't allocate space for the game state.\n");
+    exit(EXIT_FAILURE);
+  }
+  game_params_default(&game_desc, game_x);
+
+  int c;
+  while ((c = getopt(argc, argv, ":hn:w:r:k:x:y:d:S:p:i:o:u:")) != -1) {
+    switch (c) {
+    case 'h':
+      puts(HELP_TEXT);
+      exit(EXIT_SUCCESS);
+      break;
+    case 'n':
+      res.steps = strtoul(optarg, NULL, 10);
+      if (res.steps == 0) {
+        fprintf(stderr, "Number of steps cannot be 0.\n");
+        exit(EXIT_FAILURE);
+      }
+      break;
+    case 'w':
+      res.warmup = strtoul(optarg, NULL, 10);
+      break;
+    case 'r':
+      res.reps = strtoul(optarg, NULL, 10);
+      if (res.reps == 0) {
+        fprintf(stderr, "Number of repetitions cannot be 0.\n");
+        exit(EXIT_FAILURE);
+      }
+      break;
+    case 'k':
+      res.k = strtoul(optarg, NULL, 10);
+      if (res.k == 0) {
+        fprintf(stderr, "Number of instances cannot be 0.\n");
+        exit(EXIT_FAILURE);
+      }
+      break;
+    case 'x':
+      w = strtod(optarg, NULL);
+      break;
+    case 'y':
+      h = strtod(optarg, NULL);
+      break;
+    case 'd':
+      dt = strtod(optarg, NULL);
+      if (dt <= 0.0) {
+        fprintf(stderr, "Time-step must be > 0.\n");
+        exit(EXIT_FAILURE);
+      }
+      break;
+    case 'S':
+      seed = strtoul(optarg, NULL, 10);
+      break;
+    case 'p':
+      parse_param(game_x, optarg);
+      break;
+    case 'u':
+      u_period = strtod(optarg, NULL);
+      if (u_period < 0.0) {
+        fprintf(stderr, "Control period must be >= 0.\n");
+        exit(EXIT_FAILURE);
+      }
+      break;
+    case 'i':
+      method = parse_integrator(optarg);
+      set_method = true;
+      break;
+    case 'o':
+      out = optarg;
+      break;
+    case ':':
+      fprintf(stderr, "Option -%c requires an argument\n", optopt);
+      exit(EXIT_FAILURE);
+      break;
+    case '?':
+      fprintf(stderr, "Unknown option -%c\n", optopt);
+      exit(EXIT_FAILURE);
+      break;
+    }
+  }
+
+  if (res.k > 1 && game_desc.batch == NULL) {
+    fprintf(stderr, "%s has no batched variant.\n", game_desc.name);
+    exit(EXIT_FAILURE);
+  }
+
+  if (set_method && game_desc.d == NULL) {
+    fprintf(stderr, "%s has no state derivative to integrate.\n",
+            game_desc.name);
+    exit(EXIT_FAILURE);
+  }
+
+  double *ns = malloc(sizeof(double) * res.reps);
+  if (ns == NULL) {
+    fprintf(stderr, "Couldn't allocate space for the samples.\n");
+    exit(EXIT_FAILURE);
+  }
+
+  /* Set up the game and checkpoint its initial conditions, which every
+   * repetition starts from.
+   */
+
+  unsigned long before = allocs;
+  rng_seed(&rng, seed);
+  if (!game_desc.init(game_x, w, h, &rng)) {
+    fprintf(stderr, "Couldn't initialize the game.\n");
+    exit(EXIT_FAILURE);
+  }
+  if (!game_dynsys_init(&game_desc, &game, game_x)) {
+    fprintf(stderr, "Couldn't initialize the dynamic system.\n");
+    exit(EXIT_FAILURE);
+  }
+  if (set_method) dynsys_set_integrator(&game, method);
+  dynsys_set_control_period(&game, u_period);
+  if (game.method == INTEGRATOR_RK45) {
+    dynsys_tol_t tol = {
+        .rtol = DYNSYS_RTOL,
+        .atol = DYNSYS_ATOL,
+        .h_min = fmin(DYNSYS_H_MIN, dt),
+        .h_max = dt,
+    };
+    dynsys_set_tolerance(&game, &tol);
+  }
+  if (!dynsys_arena_init(&arena, &game, 1) ||
+      !dynsys_checkpoint(&arena, &game)) {
+    fprintf(stderr, "Couldn't checkpoint the game.\n");
+    exit(EXIT_FAILURE);
+  }
+  res.setup = allocs - before;
+
+  /* Every repetition must end in the same state as the first, or they didn't
+   * all time the same steps.
+   */
+
+  size_t snap_size = dynsys_snapshot_size(&game);
+  unsigned char *first = calloc(1, snap_size);
+  unsigned char *last = calloc(1, snap_size);
+  if (first == NULL || last == NULL) {
+    fprintf(stderr, "Couldn't allocate space for the snapshots.\n");
+    exit(EXIT_FAILURE);
+  }
+
+  /* Warm up the caches and branch predictors, then time the repetitions */
+
+  if (res.k > 1) {
+    double wall = run_batch(game_x, w, h, seed, dt, res.warmup, &res);
+    res.allocs = 0;
+
+    for (unsigned long i = 0; i < res.reps && wall >= 0.0; i++) {
+      wall = run_batch(game_x, w, h, seed, dt, res.steps, &res);
+      ns[i] = wall * 1e9 / (res.steps * res.k);
+    }
+    if (wall < 0.0) {
+      fprintf(stderr, "Couldn't initialize the batch.\n");
+      exit(EXIT_FAILURE);
+    }
+  } else {
+    run(&game, &arena, dt, res.warmup, &res);
+    res.restarts = 0;
+
+    before = allocs;
+    for (unsigned long i = 0; i < res.reps; i++) {
+      dynsys_rollback(&arena, &game, 0);
+      ns[i] = run(&game, &arena, dt, res.steps, &res) * 1e9 / res.steps;
+      dynsys_save(&game, i == 0 ? first : last);
+      if (i > 0 && memcmp(first, last, snap_size) != 0) {
+        fprintf(stderr, "Repetition %lu didn't replay the first one.\n", i + 1);
+        exit(EXIT_FAILURE);
+      }
+    }
+    res.allocs = allocs - before;
+  }
+
+  stats(ns, res.reps, &res.ns);
+  res.steps_per_sec = res.ns.median > 0.0 ? 1e9 / res.ns.median : 0.0;
+
+  printf("game:       %s\n", game_desc.name);
+  printf("scalar:     %s\n", REAL_NAME);
+  printf("trig:       %s\n", TRIG_NAME);
+  if (res.k > 1) printf("instances:  %zu (batched)\n", res.k);
+  printf("method:     %s\n", integrator_name(game.method));
+  printf("steps:      %lu x %lu\n", res.reps, res.steps);
+  printf("restarts:   %lu\n", res.restarts);
+  printf("ns/step:    %.1lf median, %.1lf min, %.1lf mean, %.1lf stddev\n",
+         res.ns.median, res.ns.min, res.ns.mean, res.ns.stddev);
+  printf("steps/sec:  %.0lf\n", res.steps_per_sec);
+  printf("allocs:     %lu (%lu setting up)\n", res.allocs, res.setup);
+
+  if (out != NULL) {
+    FILE *f = fopen(out, "a");
+    if (f == NULL) {
+      fprintf(stderr, "Couldn't open %s.\n", out);
+      exit(EXIT_FAILURE);
+    }
+    write_json(f, game_x, &game, dt, &res);
+    fclose(f);
+  }
+
+  /* Release resources */
+
+  dynsys_arena_free(&arena);
+  dynsys_free(&game);
+  if (game_desc.free != NULL) game_desc.free(game_x);
+  free(game_x);
+  free(ns);
+  free(first);
+  free(last);
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,45 @@
+#define HELP_TEXT \
+"Headless Runner\n\nDESCRIPTION:\n    Simulates a single example game to term" \
+"ination as fast as the CPU allows,\n    without initializing SDL. One binary" \
+" is built per example game, named\n    <example>-headless.\n\n    The game s" \
+"tarts from random initial conditions inside of a rectangular\n    arena. The" \
+" run ends when the game's terminal condition is met (i.e. a\n    capture) or" \
+" when the simulated time limit is reached, whichever comes first.\n    Captu" \
+"res are located exactly within a time-step, even when the players\n    pass " \
+"the capture radius and back between its ends. The players' controls\n    are" \
+" held over a time-step though, so the capture time still depends on it\n    " \
+"unless their strategies keep to straight paths.\n    The final cost, the sim" \
+"ulated (capture) time and the simulation throughput\n    are then printed.\n" \
+"\nUSAGE:\n    <example>-headless [OPTIONS]\n\nOPTIONS:\n    -h              " \
+"Display this help text.\n    -x <width>      Arena width in meters. Default " \
+"192.\n    -y <height>     Arena height in meters. Default 108.\n    -d <dt> " \
+"        Time-step in seconds. Default is the game's time-step.\n    -t <time" \
+">       Simulated time limit in seconds. Default 600.\n    -S <seed>       S" \
+"eed for the initial conditions. Default is current time.\n    -p <name=value" \
+"> Set a game parameter, i.e. -p capture_radius=2. May be given\n            " \
+"        multiple times.\n    -k <instances>  Simulate <instances> games at o" \
+"nce with the game's batched\n                    variant, if it has one. The" \
+" games are seeded one after the\n                    other, so the first one" \
+" is the same as without -k, and\n                    ends at the same time. " \
+"Can't be combined with -i, -u or\n                    -o.\n    -i <method>  " \
+"   Integration method: euler, rk2, rk4 or rk45. Higher-order\n              " \
+"      methods allow larger time-steps for the same accuracy.\n              " \
+"      Default is the game's method (rk4 for homicidal_chauffeur\n           " \
+"         and quadrotor, euler for the others, whose velocities are\n        " \
+"            constant over a step).\n                    rk45 picks its own s" \
+"tep sizes to keep the local error\n                    within tolerance, but" \
+" ends a step at every control\n                    update, i.e. every <dt> w" \
+"ithout -u, so that games end at\n                    the same time as with t" \
+"he other methods.\n    -e <tol>        Relative and absolute error tolerance" \
+" of rk45. Default\n                    1e-6.\n    -u <period>     Control pe" \
+"riod in seconds: the game's controller runs once\n                    per <p" \
+"eriod> of simulated time and its controls are held\n                    in b" \
+"etween. Default 0, after every time-step.\n    -o <file>       Record the tr" \
+"ajectory of every agent into <file>: a header\n                    (game, ti" \
+"me-step, number of agents and variables per\n                    agent) foll" \
+"owed by one record per time-step, holding the\n                    simulated" \
+" time as a native double and the state\n                    variables as nat" \
+"ive scalars (floats in a FLOAT=1 build),\n                    padded to a wh" \
+"ole number of doubles.\n                    At most 2^24 steps are recorded," \
+" with a warning if the\n                    run has more.\n    -l           " \
+"   List the game's parameters and their defaults, then exit.\n"
@@ -0,0 +1,326 @@
+/* Headless front-end which simulates an example game without SDL. The example
+ * is selected at link time by its game.c, which provides `game_desc`.
+ */
+
+#include <getopt.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "dynsys.h"
+#include "game.h"
+#include "headless.h"
+#include "helptext.h"
+#include "recorder.h"
+
+/* Default arena size, half of a 1920x1080 screen at the examples' default
+ * rendering scale of 5.
+ */
+
+#define ARENA_WIDTH (192.0)
+#define ARENA_HEIGHT (108.0)
+
+#define TIME_LIMIT (600.0) /* Seconds */
+
+/* Most records a trajectory file grows to. Files start with room for a record
+ * per time-step, and grow if adaptive steps turn out shorter.
+ */
+
+#define RECORD_MAX (1ul << 24)
+
+/* Simulate K instances of the game with its batched variant */
+static void run_batch(const void *tmpl, size_t k, double w, double h,
+                      double dt, double t_max, unsigned seed) {
+  const game_batch_desc_t *bd = game_desc.batch;
+  headless_batch_result_t res;
+  rng_t rng;
+  dynsys_batch_t batch;
+  double sum_t = 0.0;
+  double sum_cost = 0.0;
+
+  if (bd == NULL) {
+    fprintf(stderr, "%s has no batched variant.\n", game_desc.name);
+    exit(EXIT_FAILURE);
+  }
+
+  void *batch_x = calloc(1, bd->size);
+  double *c = malloc(sizeof(double) * k);
+  double *cost = malloc(sizeof(double) * k);
+  double *t_end = malloc(sizeof(double) * k);
+  if (batch_x == NULL || c == NULL || cost == NULL || t_end == NULL) {
+    fprintf(stderr, "Couldn't allocate space for the batch.\n");
+    exit(EXIT_FAILURE);
+  }
+
+  rng_seed(&rng, seed);
+  if (!bd->init(batch_x, tmpl, k, w, h, &rng)) {
+    fprintf(stderr, "Couldn't initialize the batch.\n");
+    exit(EXIT_FAILURE);
+  }
+  dynsys_batch_init(&batch, batch_x, k, c, bd->f, bd->u, bd->g, bd->q);
+
+  /* Simulate until every instance terminates */
+
+  headless_batch_run(&batch, bd->done, dt, t_max, t_end, &res);
+  dynsys_batch_cost(&batch, cost);
+
+  for (size_t i = 0; i < k; i++) {
+    sum_cost += cost[i];
+    if (t_end[i] >= 0.0) sum_t += t_end[i];
+  }
+
+  printf("instances:  %zu\n", k);
+  printf("terminated: %zu\n", res.n_terminated);
+  printf("mean time:  %lf s\n",
+         res.n_terminated > 0 ? sum_t / res.n_terminated : 0.0);
+  printf("mean cost:  %lf\n", sum_cost / k);
+  printf("time:       %lf s\n", res.t);
+  printf("steps:      %lu\n", res.steps);
+  printf("wall:       %lf s\n", res.wall);
+  printf("steps/sec:  %.0lf\n", res.steps_per_sec);
+
+  bd->free(batch_x);
+  free(batch_x);
+  free(c);
+  free(cost);
+  free(t_end);
+}
+
+/* Parse the name of an integration method */
+static enum integrator_e parse_integrator(const char *name) {
+  if (strcmp(name, "euler") == 0) return INTEGRATOR_EULER;
+  if (strcmp(name, "rk2") == 0) return INTEGRATOR_RK2;
+  if (strcmp(name, "rk4") == 0) return INTEGRATOR_RK4;
+  if (strcmp(name, "rk45") == 0) return INTEGRATOR_RK45;
+  fprintf(stderr, "Unknown integrator '%s'\n", name);
+  exit(EXIT_FAILURE);
+}
+
+/* Parse a parameter override of the form name=value */
+static void parse_param(void *x, char *arg) {
+  char *eq = strchr(arg, '=');
+  if (eq == NULL) {
+    fprintf(stderr, "Parameter must be given as name=value: %s\n", arg);
+    exit(EXIT_FAILURE);
+  }
+
+  *eq = '\0';
+  if (!game_param_set(&game_desc, x, arg, strtod(eq + 1, NULL))) {
+    fprintf(stderr, "%s has no parameter '%s'\n", game_desc.name, arg);
+    exit(EXIT_FAILURE);
+  }
+}
+
+int main(int argc, char **argv) {
+  double w = ARENA_WIDTH;
+  double h = ARENA_HEIGHT;
+  double dt = game_desc.dt;
+  double u_period = 0.0;
+  double t_max = TIME_LIMIT;
+  unsigned seed = time(NULL);
+  size_t k = 0;
+  const char *out = NULL;
+  rng_t rng;
+  recorder_t rec;
+  enum integrator_e method = game_desc.method;
+  bool set_method = false;
+  bool set_dt = false;
+  dynsys_tol_t tol = {
+      .rtol = DYNSYS_RTOL,
+      .atol = DYNSYS_ATOL,
+      .h_min = DYNSYS_H_MIN,
+      .h_max = DYNSYS_H_MAX,
+  };
+  headless_result_t res;
+  dynsys_t game;
+
+  void *game_x = calloc(1, game_desc.size);
+  if (game_x == NULL) {
+    fprintf(stderr, "Couldn't allocate space for the game state.\n");
+    exit(EXIT_FAILURE);
+  }
+  game_params_default(&game_desc, game_x);
+
+  int c;
+  while ((c = getopt(argc, argv, ":hlx:y:d:t:S:p:k:i:e:o:u:")) != -1) {
+    switch (c) {
+    case 'h':
+      puts(HELP_TEXT);
+      exit(EXIT_SUCCESS);
+      break;
+    case 'l':
+      for (size_t i = 0; i < game_desc.n_params; i++) {
+        printf("%s=%g\n", game_desc.params[i].name, game_desc.params[i].def);
+      }
+      exit(EXIT_SUCCESS);
+      break;
+    case 'x':
+      w = strtod(optarg, NULL);
+      break;
+    case 'y':
+      h = strtod(optarg, NULL);
+      break;
+    case 'd':
+      dt = strtod(optarg, NULL);
+      if (dt <= 0.0) {
+        fprintf(stderr, "Time-step must be > 0.\n");
+        exit(EXIT_FAILURE);
+      }
+      set_dt = true;
+      break;
+    case 't':
+      t_max = strtod(optarg, NULL);
+      if (t_max <= 0.0) {
+        fprintf(stderr, "Time limit must be > 0.\n");
+        exit(EXIT_FAILURE);
+      }
+      break;
+    case 'S':
+      seed = strtoul(optarg, NULL, 10);
+      break;
+    case 'p':
+      parse_param(game_x, optarg);
+      break;
+    case 'k':
+      k = strtoul(optarg, NULL, 10);
+      if (k == 0) {
+        fprintf(stderr, "Number of instances cannot be 0.\n");
+        exit(EXIT_FAILURE);
+      }
+      break;
+    case 'u':
+      u_period = strtod(optarg, NULL);
+      if (u_period < 0.0) {
+        fprintf(stderr, "Control period must be >= 0.\n");
+        exit(EXIT_FAILURE);
+      }
+      break;
+    case 'i':
+      method = parse_integrator(optarg);
+      set_method = true;
+      break;
+    case 'e':
+      tol.rtol = tol.atol = strtod(optarg, NULL);
+      if (tol.rtol <= 0.0) {
+        fprintf(stderr, "Error tolerance must be > 0.\n");
+        exit(EXIT_FAILURE);
+      }
+      break;
+    case 'o':
+      out = optarg;
+      break;
+    case ':':
+      fprintf(stderr, "Option -%c requires an argument\n", optopt);
+      exit(EXIT_FAILURE);
+      break;
+    case '?':
+      fprintf(stderr, "Unknown option -%c\n", optopt);
+      exit(EXIT_FAILURE);
+      break;
+    }
+  }
+
+  if (set_method && game_desc.d == NULL) {
+    fprintf(stderr, "%s has no state derivative to integrate.\n",
+            game_desc.name);
+    exit(EXIT_FAILURE);
+  }
+
+  if (k > 0 && out != NULL) {
+    fprintf(stderr, "Trajectories of batched runs can't be recorded.\n");
+    exit(EXIT_FAILURE);
+  }
+
+  if (k > 0 && (set_method || u_period > 0.0)) {
+    fprintf(stderr, "Batched runs can't change the integration method or "
+                    "control period.\n");
+    exit(EXIT_FAILURE);
+  }
+
+  /* Set up game with random initial conditions */
+
+  printf("game:       %s\n", game_desc.name);
+  printf("seed:       %u\n", seed);
+
+  if (k > 0) {
+    run_batch(game_x, k, w, h, dt, t_max, seed);
+    free(game_x);
+    return EXIT_SUCCESS;
+  }
+
+  rng_seed(&rng, seed);
+  if (!game_desc.init(game_x, w, h, &rng)) {
+    fprintf(stderr, "Couldn't initialize the game.\n");
+    exit(EXIT_FAILURE);
+  }
+  if (!game_dynsys_init(&game_desc, &game, game_x)) {
+    fprintf(stderr, "Couldn't initialize the dynamic system.\n");
+    exit(EXIT_FAILURE);
+  }
+  if (set_method) dynsys_set_integrator(&game, method);
+  dynsys_set_control_period(&game, u_period);
+
+  /* The time-step bounds the adaptive steps, if it was given */
+
+  if (set_dt) tol.h_max = dt;
+  if (tol.h_min > tol.h_max) tol.h_min = tol.h_max;
+  if (game.d != NULL) dynsys_set_tolerance(&game, &tol);
+
+  /* Record the trajectory into a file sized for a record per time-step */
+
+  if (out != NULL) {
+    uint64_t capacity = fmin(ceil(t_max / dt) + 1, RECORD_MAX);
+    if (game.d == NULL) {
+      fprintf(stderr, "%s has no state variables to record.\n",
+              game_desc.name);
+      exit(EXIT_FAILURE);
+    }
+    if (!recorder_open(&rec, out, game_desc.name, game.n,
+                       game_desc.agent_vars, dt, capacity, RECORD_MAX)) {
+      fprintf(stderr, "Couldn't create trajectory file %s.\n", out);
+      exit(EXIT_FAILURE);
+    }
+    dynsys_set_recorder(&game, &rec);
+  }
+
+  /* Simulate until termination */
+
+  headless_run(&game, game_desc.done, dt, t_max, &res);
+
+  printf("terminated: %s\n", res.terminated ? "yes" : "no");
+  printf("time:       %lf s\n", res.t);
+  printf("cost:       %lf\n", res.cost);
+  printf("steps:      %lu\n", res.steps);
+  printf("wall:       %lf s\n", res.wall);
+  printf("steps/sec:  %.0lf\n", res.steps_per_sec);
+  if (game.method == INTEGRATOR_RK45) {
+    printf("rejected:   %lu\n", game.stats.rejected);
+    printf("evals:      %lu\n", game.stats.evals);
+  }
+  if (CONFIG_PROFILE) dynsys_prof_dump(&game, stdout);
+  if (out != NULL) {
+    printf("records:    %lu\n", (unsigned long)rec.n_records);
+    if (rec.dropped > 0) {
+      printf("dropped:    %lu\n", (unsigned long)rec.dropped);
+      fprintf(stderr,
+              "Warning: trajectory file full at %lu records, the last %lu "
+              "steps weren't recorded.\n",
+              (unsigned long)rec.capacity, (unsigned long)rec.dropped);
+    }
+    if (!recorder_close(&rec)) {
+      fprintf(stderr, "Couldn't write trajectory file %s.\n", out);
+      exit(EXIT_FAILURE);
+    }
+  }
+
+  /* Release resources */
+
+  dynsys_free(&game);
+  if (game_desc.free != NULL) game_desc.free(game_x);
+  free(game_x);
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,18 @@
+#define HELP_TEXT \
+"Monte Carlo Runner\n\nDESCRIPTION:\n    Simulates many independent runs of a" \
+"n example game from random initial\n    conditions, in parallel across all c" \
+"ores and without SDL. One binary is\n    built per example game, named <exam" \
+"ple>-montecarlo.\n\n    Run i is seeded with <seed> + i, so any single run c" \
+"an be reproduced with\n    the headless runner. Statistics over all runs (fr" \
+"action of runs which\n    ended in capture, mean capture time, mean cost) ar" \
+"e printed at the end.\n\nUSAGE:\n    <example>-montecarlo [OPTIONS]\n\nOPTIO" \
+"NS:\n    -h              Display this help text.\n    -n <runs>       Number" \
+" of runs. Default 1000.\n    -j <threads>    Number of worker threads. Defau" \
+"lt is one per CPU.\n    -x <width>      Arena width in meters. Default 192." \
+"\n    -y <height>     Arena height in meters. Default 108.\n    -d <dt>     " \
+"    Time-step in seconds. Default is the game's time-step.\n    -t <time>   " \
+"    Simulated time limit of each run in seconds. Default 600.\n    -S <seed>" \
+"       Base seed for the initial conditions. Default is current\n           " \
+"         time.\n    -p <name=value> Set a game parameter, i.e. -p capture_ra" \
+"dius=2. May be given\n                    multiple times.\n    -o <file>    " \
+"   Write the result of every run to <file> as CSV.\n"
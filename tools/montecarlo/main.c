@@ -0,0 +1,173 @@
+/* Monte Carlo front-end which simulates many runs of an example game in
+ * parallel. The example is selected at link time by its game.c, which provides
+ * `game_desc`.
+ */
+
+#include <getopt.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "game.h"
+#include "headless.h"
+#include "helptext.h"
+#include "montecarlo.h"
+
+/* Default arena size, half of a 1920x1080 screen at the examples' default
+ * rendering scale of 5.
+ */
+
+#define ARENA_WIDTH (192.0)
+#define ARENA_HEIGHT (108.0)
+
+#define TIME_LIMIT (600.0) /* Seconds */
+#define N_RUNS (1000)
+
+/* Parse a parameter override of the form name=value */
+static void parse_param(void *x, char *arg) {
+  char *eq = strchr(arg, '=');
+  if (eq == NULL) {
+    fprintf(stderr, "Parameter must be given as name=value: %s\n", arg);
+    exit(EXIT_FAILURE);
+  }
+
+  *eq = '\0';
+  if (!game_param_set(&game_desc, x, arg, strtod(eq + 1, NULL))) {
+    fprintf(stderr, "%s has no parameter '%s'\n", game_desc.name, arg);
+    exit(EXIT_FAILURE);
+  }
+}
+
+/* Write one line per run */
+static void write_csv(FILE *f, const mc_result_t *results, size_t n) {
+  fprintf(f, "run,seed,ok,terminated,steps,t,cost\n");
+  for (size_t i = 0; i < n; i++) {
+    fprintf(f, "%zu,%u,%d,%d,%lu,%lf,%lf\n", i, results[i].seed, results[i].ok,
+            results[i].terminated, results[i].steps, results[i].t,
+            results[i].cost);
+  }
+}
+
+int main(int argc, char **argv) {
+  const char *outfile = NULL;
+  mc_summary_t summary;
+  mc_config_t cfg = {
+      .game = &game_desc,
+      .w = ARENA_WIDTH,
+      .h = ARENA_HEIGHT,
+      .dt = game_desc.dt,
+      .t_max = TIME_LIMIT,
+      .seed = time(NULL),
+      .n_runs = N_RUNS,
+      .n_threads = 0,
+  };
+
+  void *tmpl = calloc(1, game_desc.size);
+  if (tmpl == NULL) {
+    fprintf(stderr, "Couldn't allocate space for the game state.\n");
+    exit(EXIT_FAILURE);
+  }
+  game_params_default(&game_desc, tmpl);
+  cfg.tmpl = tmpl;
+
+  int c;
+  while ((c = getopt(argc, argv, ":hn:j:x:y:d:t:S:p:o:")) != -1) {
+    switch (c) {
+    case 'h':
+      puts(HELP_TEXT);
+      exit(EXIT_SUCCESS);
+      break;
+    case 'n':
+      cfg.n_runs = strtoul(optarg, NULL, 10);
+      if (cfg.n_runs == 0) {
+        fprintf(stderr, "Number of runs cannot be 0.\n");
+        exit(EXIT_FAILURE);
+      }
+      break;
+    case 'j':
+      cfg.n_threads = strtoul(optarg, NULL, 10);
+      break;
+    case 'x':
+      cfg.w = strtod(optarg, NULL);
+      break;
+    case 'y':
+      cfg.h = strtod(optarg, NULL);
+      break;
+    case 'd':
+      cfg.dt = strtod(optarg, NULL);
+      if (cfg.dt <= 0.0) {
+        fprintf(stderr, "Time-step must be > 0.\n");
+        exit(EXIT_FAILURE);
+      }
+      break;
+    case 't':
+      cfg.t_max = strtod(optarg, NULL);
+      if (cfg.t_max <= 0.0) {
+        fprintf(stderr, "Time limit must be > 0.\n");
+        exit(EXIT_FAILURE);
+      }
+      break;
+    case 'S':
+      cfg.seed = strtoul(optarg, NULL, 10);
+      break;
+    case 'p':
+      parse_param(tmpl, optarg);
+      break;
+    case 'o':
+      outfile = optarg;
+      break;
+    case ':':
+      fprintf(stderr, "Option -%c requires an argument\n", optopt);
+      exit(EXIT_FAILURE);
+      break;
+    case '?':
+      fprintf(stderr, "Unknown option -%c\n", optopt);
+      exit(EXIT_FAILURE);
+      break;
+    }
+  }
+
+  mc_result_t *results = malloc(sizeof(mc_result_t) * cfg.n_runs);
+  if (results == NULL) {
+    fprintf(stderr, "Couldn't allocate space for the results.\n");
+    exit(EXIT_FAILURE);
+  }
+
+  /* Simulate all runs */
+
+  if (!mc_run(&cfg, results, &summary)) {
+    fprintf(stderr, "Couldn't start the worker threads.\n");
+    exit(EXIT_FAILURE);
+  }
+
+  printf("game:         %s\n", game_desc.name);
+  printf("seed:         %u\n", cfg.seed);
+  printf("runs:         %zu\n", summary.n_runs);
+  printf("failed:       %zu\n", cfg.n_runs - summary.n_runs);
+  printf("terminated:   %zu (%.2lf%%)\n", summary.n_terminated,
+         100.0 * summary.p_terminated);
+  printf("mean time:    %lf s\n", summary.mean_t);
+  printf("mean cost:    %lf\n", summary.mean_cost);
+  printf("steps:        %lu\n", summary.steps);
+  printf("wall:         %lf s\n", summary.wall);
+  printf("steps/sec:    %.0lf\n", summary.steps_per_sec);
+
+  if (outfile != NULL) {
+    FILE *f = fopen(outfile, "w");
+    if (f == NULL) {
+      fprintf(stderr, "Couldn't open %s for writing.\n", outfile);
+      exit(EXIT_FAILURE);
+    }
+    write_csv(f, results, cfg.n_runs);
+    fclose(f);
+  }
+
+  /* Release resources */
+
+  free(results);
+  free(tmpl);
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,31 @@
+#define HELP_TEXT \
+"Parameter Sweep\n\nDESCRIPTION:\n    Runs an example game over a grid of par" \
+"ameter values, with many runs from\n    random initial conditions in every g" \
+"rid cell, in parallel across all cores\n    and without SDL. One binary is b" \
+"uilt per example game, named\n    <example>-sweep.\n\n    Every swept parame" \
+"ter is given with -P, either as a list of values or as a\n    range of evenl" \
+"y spaced values. The grid is every combination of the values,\n    the last " \
+"parameter varying fastest. Every cell runs the same seeds (run i is\n    see" \
+"ded with <seed> + i, as in the Monte Carlo runner), so differences\n    betw" \
+"een cells come from the parameters and not from the initial\n    conditions." \
+"\n\n    One CSV row is written per cell: the swept parameters, the number of" \
+" runs\n    and of runs ending in capture, the fraction of captures, the mean" \
+", 10%,\n    median and 90% capture time over the captured runs (nan if there" \
+" are none)\n    and the mean final cost.\n\nUSAGE:\n    <example>-sweep -P <" \
+"name=values> [OPTIONS]\n\nOPTIONS:\n    -h              Display this help te" \
+"xt.\n    -P <name=values>\n                    Sweep a game parameter over a" \
+" list of values, i.e.\n                    -P capture_radius=0,1,2, or over " \
+"<count> evenly spaced\n                    values from <first> to <last>, i." \
+"e. -P turn_radius=1:10:10.\n                    May be given for up to 8 par" \
+"ameters.\n    -n <runs>       Number of runs per cell. Default 200.\n    -j " \
+"<threads>    Number of worker threads. Default is one per CPU.\n    -x <widt" \
+"h>      Arena width in meters. Default 192.\n    -y <height>     Arena heigh" \
+"t in meters. Default 108.\n    -d <dt>         Time-step in seconds. Default" \
+" is the game's time-step.\n    -t <time>       Simulated time limit of each " \
+"run in seconds. Default 600.\n    -S <seed>       Base seed for the initial " \
+"conditions. Default is current\n                    time.\n    -p <name=valu" \
+"e> Set a game parameter which isn't swept, i.e. -p n=3. May be\n            " \
+"        given multiple times.\n    -o <file>       Write the table to <file>" \
+" instead of the standard output.\n\nEXAMPLES:\n    homicidal_chauffeur-sweep" \
+" -P pedestrian_vel=10:40:7 -P turn_radius=2,5,10\n    npne-sweep -p n=3 -P e" \
+"_vel_max=15:35:5 -o npne.csv\n"
@@ -0,0 +1,321 @@
+/* Parameter sweep front-end which runs an example game over a grid of parameter
+ * values, many runs per grid cell. The example is selected at link time by its
+ * game.c, which provides `game_desc`.
+ */
+
+#include <getopt.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "game.h"
+#include "headless.h"
+#include "helptext.h"
+#include "montecarlo.h"
+
+/* Default arena size, half of a 1920x1080 screen at the examples' default
+ * rendering scale of 5.
+ */
+
+#define ARENA_WIDTH (192.0)
+#define ARENA_HEIGHT (108.0)
+
+#define TIME_LIMIT (600.0) /* Seconds */
+#define N_RUNS (200)       /* Runs per grid cell */
+#define MAX_AXES (8)
+
+/* One parameter of the grid and the values it takes */
+
+typedef struct {
+  char *name;     /* Name of the game parameter */
+  double *values; /* Values of the parameter */
+  size_t n;       /* Number of values */
+} axis_t;
+
+/* Statistics of a grid cell */
+
+typedef struct {
+  mc_summary_t summary; /* Runs, captures, mean capture time and cost */
+  double q10;           /* Capture time quantiles over the captured runs */
+  double median;
+  double q90;
+} cell_t;
+
+/* Parse a parameter override of the form name=value */
+static void parse_param(void *x, char *arg) {
+  char *eq = strchr(arg, '=');
+  if (eq == NULL) {
+    fprintf(stderr, "Parameter must be given as name=value: %s\n", arg);
+    exit(EXIT_FAILURE);
+  }
+
+  *eq = '\0';
+  if (!game_param_set(&game_desc, x, arg, strtod(eq + 1, NULL))) {
+    fprintf(stderr, "%s has no parameter '%s'\n", game_desc.name, arg);
+    exit(EXIT_FAILURE);
+  }
+}
+
+/* Parse an axis of the form name=v1,v2,... or name=first:last:count */
+static void parse_axis(axis_t *a, const void *x, char *arg) {
+  double v;
+  char *eq = strchr(arg, '=');
+  if (eq == NULL) {
+    fprintf(stderr, "Sweep must be given as name=values: %s\n", arg);
+    exit(EXIT_FAILURE);
+  }
+
+  *eq = '\0';
+  a->name = arg;
+  if (!game_param_get(&game_desc, x, arg, &v)) {
+    fprintf(stderr, "%s has no parameter '%s'\n", game_desc.name, arg);
+    exit(EXIT_FAILURE);
+  }
+
+  /* Evenly spaced values, including both ends */
+
+  char *vals = eq + 1;
+  if (strchr(vals, ':') != NULL) {
+    double first, last;
+    unsigned long count;
+    if (sscanf(vals, "%lf:%lf:%lu", &first, &last, &count) != 3 ||
+        count == 0) {
+      fprintf(stderr, "Range must be given as first:last:count: %s\n", vals);
+      exit(EXIT_FAILURE);
+    }
+
+    a->n = count;
+    a->values = malloc(sizeof(double) * a->n);
+    if (a->values == NULL) goto err_alloc;
+    double step = a->n > 1 ? (last - first) / (a->n - 1) : 0.0;
+    for (size_t i = 0; i < a->n; i++) a->values[i] = first + step * i;
+    return;
+  }
+
+  /* List of values */
+
+  a->n = 1;
+  for (char *p = vals; *p != '\0'; p++) a->n += *p == ',';
+  a->values = malloc(sizeof(double) * a->n);
+  if (a->values == NULL) goto err_alloc;
+
+  char *tok = vals;
+  for (size_t i = 0; i < a->n; i++) {
+    char *end;
+    a->values[i] = strtod(tok, &end);
+    if (end == tok || (*end != ',' && *end != '\0')) {
+      fprintf(stderr, "Invalid value for %s: %s\n", a->name, tok);
+      exit(EXIT_FAILURE);
+    }
+    tok = end + 1;
+  }
+  return;
+
+err_alloc:
+  fprintf(stderr, "Couldn't allocate space for the values of %s.\n", a->name);
+  exit(EXIT_FAILURE);
+}
+
+static int cmp_double(const void *a, const void *b) {
+  double x = *(const double *)a;
+  double y = *(const double *)b;
+  return (x > y) - (x < y);
+}
+
+/* Linearly interpolated quantile of sorted values, NAN if there are none */
+static double quantile(const double *v, size_t n, double q) {
+  if (n == 0) return NAN;
+
+  double pos = q * (n - 1);
+  size_t i = (size_t)pos;
+  if (i + 1 >= n) return v[n - 1];
+  return v[i] + (pos - i) * (v[i + 1] - v[i]);
+}
+
+/* Capture time quantiles of a cell. `t` has space for every run. */
+static void cell_quantiles(cell_t *cell, const mc_result_t *results,
+                           size_t n_runs, double *t) {
+  size_t n = 0;
+
+  for (size_t i = 0; i < n_runs; i++) {
+    if (results[i].ok && results[i].terminated) t[n++] = results[i].t;
+  }
+  qsort(t, n, sizeof(double), cmp_double);
+
+  cell->q10 = quantile(t, n, 0.1);
+  cell->median = quantile(t, n, 0.5);
+  cell->q90 = quantile(t, n, 0.9);
+}
+
+static void write_header(FILE *f, const axis_t *axes, size_t n_axes) {
+  for (size_t a = 0; a < n_axes; a++) fprintf(f, "%s,", axes[a].name);
+  fprintf(f, "runs,terminated,p_terminated,mean_t,q10_t,median_t,q90_t,"
+             "mean_cost\n");
+}
+
+static void write_row(FILE *f, const double *point, size_t n_axes,
+                      const cell_t *cell) {
+  const mc_summary_t *s = &cell->summary;
+
+  for (size_t a = 0; a < n_axes; a++) fprintf(f, "%g,", point[a]);
+  fprintf(f, "%zu,%zu,%lf,%lf,%lf,%lf,%lf,%lf\n", s->n_runs, s->n_terminated,
+          s->p_terminated, s->n_terminated > 0 ? s->mean_t : NAN, cell->q10,
+          cell->median, cell->q90, s->mean_cost);
+}
+
+int main(int argc, char **argv) {
+  const char *outfile = NULL;
+  axis_t axes[MAX_AXES];
+  size_t n_axes = 0;
+  mc_config_t cfg = {
+      .game = &game_desc,
+      .w = ARENA_WIDTH,
+      .h = ARENA_HEIGHT,
+      .dt = game_desc.dt,
+      .t_max = TIME_LIMIT,
+      .seed = time(NULL),
+      .n_runs = N_RUNS,
+      .n_threads = 0,
+  };
+
+  void *tmpl = calloc(1, game_desc.size);
+  if (tmpl == NULL) {
+    fprintf(stderr, "Couldn't allocate space for the game state.\n");
+    exit(EXIT_FAILURE);
+  }
+  game_params_default(&game_desc, tmpl);
+  cfg.tmpl = tmpl;
+
+  int c;
+  while ((c = getopt(argc, argv, ":hn:j:x:y:d:t:S:p:P:o:")) != -1) {
+    switch (c) {
+    case 'h':
+      puts(HELP_TEXT);
+      exit(EXIT_SUCCESS);
+      break;
+    case 'n':
+      cfg.n_runs = strtoul(optarg, NULL, 10);
+      if (cfg.n_runs == 0) {
+        fprintf(stderr, "Number of runs cannot be 0.\n");
+        exit(EXIT_FAILURE);
+      }
+      break;
+    case 'j':
+      cfg.n_threads = strtoul(optarg, NULL, 10);
+      break;
+    case 'x':
+      cfg.w = strtod(optarg, NULL);
+      break;
+    case 'y':
+      cfg.h = strtod(optarg, NULL);
+      break;
+    case 'd':
+      cfg.dt = strtod(optarg, NULL);
+      if (cfg.dt <= 0.0) {
+        fprintf(stderr, "Time-step must be > 0.\n");
+        exit(EXIT_FAILURE);
+      }
+      break;
+    case 't':
+      cfg.t_max = strtod(optarg, NULL);
+      if (cfg.t_max <= 0.0) {
+        fprintf(stderr, "Time limit must be > 0.\n");
+        exit(EXIT_FAILURE);
+      }
+      break;
+    case 'S':
+      cfg.seed = strtoul(optarg, NULL, 10);
+      break;
+    case 'p':
+      parse_param(tmpl, optarg);
+      break;
+    case 'P':
+      if (n_axes == MAX_AXES) {
+        fprintf(stderr, "At most %d parameters can be swept.\n", MAX_AXES);
+        exit(EXIT_FAILURE);
+      }
+      parse_axis(&axes[n_axes++], tmpl, optarg);
+      break;
+    case 'o':
+      outfile = optarg;
+      break;
+    case ':':
+      fprintf(stderr, "Option -%c requires an argument\n", optopt);
+      exit(EXIT_FAILURE);
+      break;
+    case '?':
+      fprintf(stderr, "Unknown option -%c\n", optopt);
+      exit(EXIT_FAILURE);
+      break;
+    }
+  }
+
+  if (n_axes == 0) {
+    fprintf(stderr, "Nothing to sweep, give parameters with -P.\n");
+    exit(EXIT_FAILURE);
+  }
+
+  size_t n_cells = 1;
+  for (size_t a = 0; a < n_axes; a++) n_cells *= axes[a].n;
+
+  mc_result_t *results = malloc(sizeof(mc_result_t) * cfg.n_runs);
+  double *t = malloc(sizeof(double) * cfg.n_runs);
+  if (results == NULL || t == NULL) {
+    fprintf(stderr, "Couldn't allocate space for the results.\n");
+    exit(EXIT_FAILURE);
+  }
+
+  FILE *f = stdout;
+  if (outfile != NULL) {
+    f = fopen(outfile, "w");
+    if (f == NULL) {
+      fprintf(stderr, "Couldn't open %s for writing.\n", outfile);
+      exit(EXIT_FAILURE);
+    }
+  }
+
+  fprintf(stderr, "game:  %s\n", game_desc.name);
+  fprintf(stderr, "seed:  %u\n", cfg.seed);
+  fprintf(stderr, "cells: %zu x %zu runs\n", n_cells, cfg.n_runs);
+  write_header(f, axes, n_axes);
+
+  /* Every cell runs the same seeds, so that differences between cells come
+   * from the parameters rather than the initial conditions. The last axis
+   * varies fastest.
+   */
+
+  double start = headless_now();
+  for (size_t i = 0; i < n_cells; i++) {
+    double point[MAX_AXES];
+    cell_t cell;
+
+    size_t rest = i;
+    for (size_t a = n_axes; a-- > 0;) {
+      point[a] = axes[a].values[rest % axes[a].n];
+      rest /= axes[a].n;
+      game_param_set(&game_desc, tmpl, axes[a].name, point[a]);
+    }
+
+    if (!mc_run(&cfg, results, &cell.summary)) {
+      fprintf(stderr, "Couldn't start the worker threads.\n");
+      exit(EXIT_FAILURE);
+    }
+    cell_quantiles(&cell, results, cfg.n_runs, t);
+    write_row(f, point, n_axes, &cell);
+    fflush(f);
+  }
+  fprintf(stderr, "wall:  %lf s\n", headless_now() - start);
+
+  /* Release resources */
+
+  if (f != stdout) fclose(f);
+  for (size_t a = 0; a < n_axes; a++) free(axes[a].values);
+  free(results);
+  free(t);
+  free(tmpl);
+
+  return EXIT_SUCCESS;
+}